@@ -1,12 +1,40 @@
 #pragma once
 #include <opencv2/opencv.hpp>
+#include <optional>
+#include <string>
 #include <vector>
+#include "BarcodeResult.h"
 #include "DecodeException.h"
 #include "BarcodeException.h"
 
+// Код, найденный OpenCV: контур из 4 точек и то, что OpenCV сам прочитал.
+// type/data пусты, если OpenCV нашёл код, но не смог его декодировать
+struct OpenCVDetection {
+    std::vector<cv::Point> polygon;
+    std::string type;   // в именах ZBar: EAN-13, EAN-8, UPC-A, UPC-E
+    std::string data;
+
+    bool isDecoded() const { return !data.empty(); }
+};
+
+// Полигон, развёрнутый перспективным преобразованием в горизонтальную полосу фиксированной высоты:
+// длинная сторона полигона идёт вдоль полосы, штрихи вертикальны
+struct RectifiedStrip {
+    cv::Mat image;
+    cv::Mat toFrame;   // 3x3 CV_64F: точки полосы -> точки кадра
+
+    std::vector<cv::Point> mapToFrame(const std::vector<cv::Point>& points) const;
+};
+
 class BarcodeDetectorOpenCV {
 public:
     std::vector<std::vector<cv::Point>> detectWithOpenCV(const cv::Mat& frame) const;
+    // Контуры вместе с результатами detectAndDecodeWithType
+    std::vector<OpenCVDetection> detectAndDecode(const cv::Mat& frame) const;
+    static BarcodeResult toBarcodeResult(const OpenCVDetection& detection);
+    // Полоса для декодирования вместо ограничивающего прямоугольника: без фона и поворота.
+    // nullopt — полигон не четырёхугольник или вырожден
+    static std::optional<RectifiedStrip> rectify(const cv::Mat& gray, const std::vector<cv::Point>& polygon);
 private:
     cv::barcode::BarcodeDetector opencv_detector;
 };
@@ -1,34 +1,85 @@
 #pragma once
 #include <opencv2/opencv.hpp>
+#include <QThreadPool>
+#include <mutex>
+#include <optional>
+#include <span>
 #include <string>
 #include <vector>
 #include "BarcodeDetectorOpenCV1D.h"
 #include "CurvedBarcodeDetector.h"
+#include "FrameContext.h"
 #include "ImagePreprocessor.h"
 #include "ZBarDecoder.h"
 #include "SmartDecoder.h"
 #include "BarcodeResult.h"
+#include "CancellationToken.h"
+#include "ScanOptions.h"
 #include "Country.h"
 #include "Decoder.h"
 
 class FailureAnalysis;
 
+// Время распознавания одного изогнутого региона-кандидата
+struct RegionTiming {
+    cv::Rect rect;
+    double score = 0.0;
+    double milliseconds = 0.0;
+    bool decoded = false;
+    bool cancelled = false;
+};
+
 class BarcodeReader : public AbstractDecoder {
 public:
     BarcodeReader();
     ~BarcodeReader() override;
     BarcodeResult decode(const cv::Mat& image) override;
     BarcodeResult decode(const std::string& filename) override;
+    // Распознавание со сроком: вместо DecodeException возвращает статус (распознан / не найден / время истекло)
+    // и отчёт о том, докуда дошла каждая стадия
+    ScanReport decode(const cv::Mat& image, const ScanOptions& options);
+    // Все коды кадра: каждая стадия проходит один раз, повторы между стадиями схлопываются,
+    // результаты обогащаются пакетом и содержат контур кода (location)
+    std::vector<BarcodeResult> decodeAll(const cv::Mat& image, const ScanOptions& options = ScanOptions{});
     std::string getDecoderName() const override { return "BarcodeReader"; }
     BarcodeResult advancedDecode(const cv::Mat& image);
+    // Все стратегии сразу на пуле потоков; результат тот же, что у advancedDecode
+    BarcodeResult advancedDecodeConcurrent(const cv::Mat& image);
+    // Параллельный режим для decode()/advancedDecode() (по умолчанию выключен): полнокадровый ZBar
+    // стартует сразу и не прерывается, поэтому продолжает работать после победы других стадий
+    void setConcurrentStages(bool enabled) { concurrentStages = enabled; }
+    bool isConcurrentStages() const { return concurrentStages; }
+    // Замеры по регионам последнего прохода изогнутой стадии (в порядке оценки)
+    std::vector<RegionTiming> lastRegionTimings() const;
     BarcodeResult createDetailedResult(const BarcodeResult& basicResult);
+    // Пакетное обогащение: одинаковые коды ищутся в справочниках один раз, результаты заполняются на месте
+    void enrichResults(std::span<BarcodeResult> results);
     void saveToFile(const BarcodeResult& result) override;
 private:
+    // Стратегии advancedDecode в порядке приоритета
+    enum class DecodeStage { OpenCV, Curved, FullFrame };
+    static constexpr int kStageCount = 3;
+    struct StageLog;
+
+    ScanReport runScan(const cv::Mat& image, const ScanOptions& options, bool concurrent);
+    BarcodeResult resultOrThrow(const ScanReport& report);
+    std::optional<BarcodeResult> runTrackedStage(DecodeStage stage, const FrameContext& frame, ZBarDecoder& zbar,
+                                                 SmartDecoder& smart, const CancellationToken& cancel, StageLog& log);
+    std::optional<BarcodeResult> runStage(DecodeStage stage, const FrameContext& frame, ZBarDecoder& zbar,
+                                          SmartDecoder& smart, const CancellationToken& cancel);
+    std::optional<BarcodeResult> decodeCurvedRegions(const FrameContext& frame, SmartDecoder& smart,
+                                                     const CancellationToken& cancel);
+
     [[no_unique_address]] BarcodeDetectorOpenCV opencvDetector;
     [[no_unique_address]] CurvedBarcodeDetector curvedDetector;
     [[no_unique_address]] ImagePreprocessor preprocessor;
     [[no_unique_address]] ZBarDecoder zbarDecoder;
     [[no_unique_address]] SmartDecoder smartDecoder;
+    bool concurrentStages = false;
+    mutable std::mutex timingsMutex;
+    std::vector<RegionTiming> regionTimings;
+    QThreadPool regionPool;
+    QThreadPool stagePool;   // объявлен последним: разрушается первым и дожидается отменённых стадий
     std::vector<cv::Rect> detectCurvedBarcodesOptimized(const cv::Mat& image);
     std::string filterBarcodeResult(const std::string& result);
     BarcodeResult parseZBarResult(const std::string& zbarResult);
@@ -39,6 +90,8 @@ private:
     std::string findAdditionalProduct(std::string_view digits);
     std::string findCountryForEAN8(std::string_view digits);
     std::string findProductForEAN8(std::string_view digits);
+    BarcodeResult composeDetailedResult(const BarcodeResult& basicResult, std::string productText,
+                                        std::string manufacturerText);
     bool isEAN13orUPCA(const BarcodeResult& result);
     bool isEAN8(const BarcodeResult& result);
     std::string normalizeDigits(const BarcodeResult& result);
@@ -1,5 +1,7 @@
 #pragma once
+#include <opencv2/core/types.hpp>
 #include <string>
+#include <vector>
 
 class BarcodeResult {
 public:
@@ -9,4 +11,5 @@ public:
     std::string country;
     std::string manufacturerCode;
     std::string productCode;
+    std::vector<cv::Point> location;   // контур кода в координатах кадра (пусто — неизвестен)
 };
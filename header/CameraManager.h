@@ -1,30 +1,60 @@
 #pragma once
 #include <QObject>
-#include <QTimer>
 #include <opencv2/opencv.hpp>
+#include <atomic>
+#include <cstdint>
+#include <thread>
+#include "FrameRing.h"
 
 class CameraManager : public QObject
 {
     Q_OBJECT
 public:
+    // Счётчики захвата. dropped — кадры, которые ни один потребитель не успел взять
+    // (вытеснены следующим или не нашлось свободного слота); latency — время чтения кадра с камеры
+    struct CaptureStats
+    {
+        std::uint64_t captured = 0;
+        std::uint64_t dropped = 0;
+        double lastLatencyMs = 0.0;
+        double averageLatencyMs = 0.0;
+    };
+
     explicit CameraManager(QObject* parent = nullptr);
     ~CameraManager() override;
     bool startCamera(int cameraIndex = 0);
     void stopCamera();
     bool isCameraActive() const;
+    // Последний кадр без копии: слот кольца закреплён, пока жив FrameRef.
+    // Разрешает следующий сигнал frameReady — для потребителя этого сигнала
+    FrameRing::FrameRef latestFrame() const;
+    // То же, но сигнал frameReady не затрагивает — для потребителей frameCaptured
+    FrameRing::FrameRef peekFrame() const;
+    // Копия последнего кадра
     cv::Mat getCurrentFrame() const;
     void setMirrorMode(bool enabled);
+    CaptureStats captureStats() const;
 signals:
-    void frameReady(const cv::Mat& frame);
+    // Испускается из потока захвата; пока потребитель не взял кадр через latestFrame(),
+    // новые сигналы не ставятся в очередь — он всегда получает самый свежий кадр
+    void frameReady();
+    // Испускается из потока захвата на каждый кадр, без ограничения: только для прямого соединения
+    // с потокобезопасным обработчиком, который лишь будит свой поток
+    void frameCaptured();
     void cameraStarted();
     void cameraStopped();
     void cameraError(const QString& error);
 private:
-    void updateFrame();
+    void captureLoop();
     bool tryOpenCameraWithBackend(int cameraIndex, int backend);
     cv::VideoCapture* videoCapture = nullptr;
-    QTimer* frameTimer = nullptr;
     bool cameraActive = false;
-    bool mirrorMode = true;
-    cv::Mat currentFrame;
+    std::atomic<bool> mirrorMode{true};
+
+    FrameRing frames;
+    std::thread captureThread;
+    std::atomic<bool> capturing{false};
+    mutable std::atomic<bool> notifyPending{false};
+    std::atomic<std::uint64_t> lastLatencyMicros{0};
+    std::atomic<std::uint64_t> averageLatencyMicros{0};
 };
@@ -0,0 +1,33 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+
+// Флаг кооперативной отмены стадии распознавания.
+// Стадия проверяет его между регионами и вариантами предобработки и завершается без результата.
+// Токен с родителем считается отменённым и тогда, когда отменён родитель.
+// Срок (deadline) — та же отмена, но по времени: после него isCancelled() и isTimedOut() возвращают true
+class CancellationToken {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    explicit CancellationToken(const CancellationToken* parent = nullptr) : parent(parent) {}
+
+    CancellationToken(const CancellationToken&) = delete;
+    CancellationToken& operator=(const CancellationToken&) = delete;
+
+    void cancel() { cancelled.store(true, std::memory_order_relaxed); }
+    void setDeadline(Clock::time_point until) { deadline = until; }
+
+    bool isCancelled() const {
+        return cancelled.load(std::memory_order_relaxed) || isTimedOut() || (parent && parent->isCancelled());
+    }
+    bool isTimedOut() const {
+        return (deadline != Clock::time_point::max() && Clock::now() >= deadline)
+               || (parent && parent->isTimedOut());
+    }
+
+private:
+    const CancellationToken* parent;
+    Clock::time_point deadline = Clock::time_point::max();
+    std::atomic<bool> cancelled{false};
+};
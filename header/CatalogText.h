@@ -0,0 +1,92 @@
+#pragma once
+#include <QChar>
+#include <QString>
+#include <string>
+#include <string_view>
+
+// Общие помощники разбора текстовых справочников (data/*.txt) без QString на каждую строку
+
+inline char16_t catalogCharCode(char ch) { return static_cast<unsigned char>(ch); }
+inline char16_t catalogCharCode(QChar ch) { return ch.unicode(); }
+
+inline bool isAsciiDigit(char16_t code) { return code >= u'0' && code <= u'9'; }
+
+inline std::string_view trimmedView(std::string_view text)
+{
+    constexpr std::string_view whitespace = " \t\r\n\v\f";
+    const auto first = text.find_first_not_of(whitespace);
+    if (first == std::string_view::npos) return {};
+    const auto last = text.find_last_not_of(whitespace);
+    return text.substr(first, last - first + 1);
+}
+
+inline QString qStringFromUtf8(std::string_view text)
+{
+    return QString::fromUtf8(text.data(), static_cast<qsizetype>(text.size()));
+}
+
+// Обход непустых строк файла, кроме комментариев '#'; строки уже обрезаны по краям
+template <typename LineHandler>
+void forEachCatalogLine(std::string_view text, LineHandler&& handler)
+{
+    std::size_t lineStart = 0;
+    while (lineStart < text.size()) {
+        auto lineEnd = text.find('\n', lineStart);
+        if (lineEnd == std::string_view::npos) lineEnd = text.size();
+        const std::string_view line = trimmedView(text.substr(lineStart, lineEnd - lineStart));
+        lineStart = lineEnd + 1;
+
+        if (line.empty() || line.front() == '#') continue;
+        handler(line);
+    }
+}
+
+// Строка Barcode_Products.txt: "штрих-код | производитель | название"
+template <typename RecordHandler>
+void forEachProductRecord(std::string_view text, RecordHandler&& handler)
+{
+    forEachCatalogLine(text, [&handler](std::string_view line) {
+        const auto firstBar = line.find('|');
+        if (firstBar == std::string_view::npos) return;
+        const auto secondBar = line.find('|', firstBar + 1);
+        if (secondBar == std::string_view::npos || line.find('|', secondBar + 1) != std::string_view::npos) return;
+
+        handler(trimmedView(line.substr(0, firstBar)),
+                trimmedView(line.substr(firstBar + 1, secondBar - firstBar - 1)),
+                trimmedView(line.substr(secondBar + 1)));
+    });
+}
+
+// Строка Barcode_Manufacturers.txt: "код:название:код страны"
+template <typename RecordHandler>
+void forEachManufacturerRecord(std::string_view text, RecordHandler&& handler)
+{
+    forEachCatalogLine(text, [&handler](std::string_view line) {
+        const auto firstColon = line.find(':');
+        if (firstColon == std::string_view::npos) return;
+        const auto secondColon = line.find(':', firstColon + 1);
+        if (secondColon == std::string_view::npos || line.find(':', secondColon + 1) != std::string_view::npos) return;
+
+        handler(trimmedView(line.substr(0, firstColon)),
+                trimmedView(line.substr(firstColon + 1, secondColon - firstColon - 1)),
+                trimmedView(line.substr(secondColon + 1)));
+    });
+}
+
+// Текст, который показывается пользователю для найденного товара / производителя
+inline std::string productDescription(std::string_view barcode, std::string_view manufacturer, std::string_view name)
+{
+    std::string description;
+    description.reserve(name.size() + manufacturer.size() + barcode.size() + 40);
+    description.append(name).append(" (Производитель: ").append(manufacturer)
+        .append(", ШК: ").append(barcode).append(")");
+    return description;
+}
+
+inline std::string manufacturerDescription(std::string_view code, std::string_view name, std::string_view country)
+{
+    std::string description;
+    description.reserve(name.size() + code.size() + country.size() + 24);
+    description.append(name).append(" (").append(code).append("), страна: ").append(country);
+    return description;
+}
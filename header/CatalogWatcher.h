@@ -0,0 +1,52 @@
+#ifndef CATALOGWATCHER_H
+#define CATALOGWATCHER_H
+
+#include <QObject>
+#include <QString>
+#include <QHash>
+#include <QDateTime>
+#include <QElapsedTimer>
+#include <QThreadPool>
+
+class QFileSystemWatcher;
+class QTimer;
+
+// Следит за справочниками в data/ и перестраивает индексы в фоне.
+// Новый индекс публикуется атомарной подменой снимка, потоки декодирования не блокируются
+class CatalogWatcher : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit CatalogWatcher(const QString& dataDir, QObject* parent = nullptr);
+    ~CatalogWatcher() override;
+
+signals:
+    // buildMs — построение индекса, latencyMs — от обнаружения изменения до публикации
+    void catalogReloaded(const QString& fileName, qint64 buildMs, qint64 latencyMs);
+    void catalogReloadFailed(const QString& fileName, const QString& error);
+
+private:
+    struct FileStamp
+    {
+        QDateTime modified;
+        qint64 size = -1;
+        bool operator==(const FileStamp& other) const = default;
+    };
+
+    void onPathChanged();
+    void checkForChanges();
+    void watchExistingFiles();
+    FileStamp stampOf(const QString& fileName) const;
+    void reloadInBackground(const QString& fileName, qint64 detectedAt);
+
+    QString dataDir;
+    QFileSystemWatcher* watcher = nullptr;
+    QTimer* debounceTimer = nullptr;
+    QThreadPool reloadPool;                 // один поток: перезагрузки идут строго по очереди
+    QHash<QString, FileStamp> knownStamps;
+    QElapsedTimer clock;
+    qint64 firstChangeAt = -1;
+};
+
+#endif // CATALOGWATCHER_H
@@ -0,0 +1,108 @@
+#ifndef COMPILEDCATALOG_H
+#define COMPILEDCATALOG_H
+
+#include <QFile>
+#include <QString>
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <string_view>
+#include "CountryCatalog.h"
+
+// Скомпилированный каталог (Barcode_Catalog.bin), собирается утилитой catalog-compile.
+// Файл отображается в память (mmap через QFile::map) и не разбирается при старте:
+// поиск — бинарный поиск по отсортированным ключам прямо в отображённых страницах,
+// поэтому несколько процессов сканера делят одни и те же страницы page cache.
+//
+// Формат (little-endian, все смещения от начала файла, массивы выровнены по 8 байт):
+//   Header
+//   u64[productCount]        — ключи товаров (ProductCatalog::productKey), по возрастанию
+//   u32[productCount]        — смещения описаний товаров в пуле строк
+//   u64[manufacturerCount]   — упакованные коды производителей, по возрастанию
+//   u32[manufacturerCount]   — смещения описаний производителей
+//   u32[countryCount]        — смещения названий стран (id страны = индекс + 1)
+//   u16[1000], u16[100]      — таблицы префиксов стран (CountryPrefixTable)
+//   пул строк                — записи вида [u32 длина][байты UTF-8]
+class CompiledCatalog
+{
+public:
+    static constexpr std::uint32_t kFormatVersion = 2;   // 2: UPC-A хранится как GTIN-13
+
+    struct Header
+    {
+        char magic[8];
+        std::uint32_t version;
+        std::uint32_t headerSize;
+        std::uint64_t fileSize;
+        std::uint64_t productCount;
+        std::uint64_t productKeysOffset;
+        std::uint64_t productStringsOffset;
+        std::uint64_t manufacturerCount;
+        std::uint64_t manufacturerKeysOffset;
+        std::uint64_t manufacturerStringsOffset;
+        std::uint64_t countryCount;
+        std::uint64_t countryStringsOffset;
+        std::uint64_t countryPrefix3Offset;
+        std::uint64_t countryPrefix2Offset;
+        std::uint64_t stringPoolOffset;
+        std::uint64_t stringPoolSize;
+        std::uint64_t payloadChecksum;   // FNV-1a 64 по всем байтам после заголовка
+        std::uint64_t headerChecksum;    // FNV-1a 64 по заголовку до этого поля
+    };
+
+    struct BuildStats
+    {
+        std::size_t products = 0;
+        std::size_t manufacturers = 0;
+        std::size_t countries = 0;
+        qint64 fileSize = 0;
+    };
+
+    CompiledCatalog() = default;
+    ~CompiledCatalog();
+
+    CompiledCatalog(const CompiledCatalog&) = delete;
+    CompiledCatalog& operator=(const CompiledCatalog&) = delete;
+
+    // Открытие и проверка заголовка/границ секций; verifyPayload — дополнительно контрольная сумма всего файла
+    bool open(const QString& filePath, bool verifyPayload = false);
+    void close();
+    bool isOpen() const { return data != nullptr; }
+
+    // Пустая строка — ключ не найден
+    QString findProduct(std::uint64_t key) const;
+    QString findManufacturer(std::uint64_t key) const;
+    // Пакетный поиск по ключам, отсортированным по возрастанию: проход по файлу только вперёд
+    void findProducts(std::span<const std::uint64_t> sortedKeys, std::span<QString> descriptions) const;
+    CountryPrefixTable countryTable() const;
+
+    // Ключ товара по порядку — для проверки каталога
+    std::uint64_t productKey(std::size_t position) const;
+
+    // Записи производителей по порядку ключей — для построения дерева префиксов
+    std::uint64_t manufacturerKey(std::size_t position) const;
+    QString manufacturerAt(std::size_t position) const;
+
+    std::size_t productCount() const { return header ? header->productCount : 0; }
+    std::size_t manufacturerCount() const { return header ? header->manufacturerCount : 0; }
+
+    // Каталог по умолчанию (data/Barcode_Catalog.bin) или nullptr, если файла нет или он повреждён.
+    // Отображение живёт, пока на него есть ссылки, поэтому его можно подменить на лету
+    static std::shared_ptr<const CompiledCatalog> defaultCatalog();
+    static void reloadDefault();
+
+    // Сборка бинарного каталога из трёх текстовых файлов; бросает FileException
+    static BuildStats compile(const QString& productsPath, const QString& manufacturersPath,
+                              const QString& countriesPath, const QString& outputPath);
+
+private:
+    QString findString(std::uint64_t keysOffset, std::uint64_t stringsOffset, std::uint64_t count,
+                       std::uint64_t key) const;
+    std::string_view stringAt(std::uint32_t poolOffset) const;
+
+    std::unique_ptr<QFile> file;
+    const uchar* data = nullptr;
+    const Header* header = nullptr;
+};
+
+#endif // COMPILEDCATALOG_H
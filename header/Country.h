@@ -18,7 +18,7 @@ public:
 
     bool isValid() const;
 
-    // 📂 Новый метод: поиск страны по первым 2–3 цифрам штрих-кода
+    // 📂 Поиск страны по первым 2–3 цифрам штрих-кода (через таблицу CountryCatalog)
     static QString findCountryByBarcode(const QString& barcode);
 };
 
@@ -0,0 +1,72 @@
+#ifndef COUNTRYCATALOG_H
+#define COUNTRYCATALOG_H
+
+#include <QString>
+#include <QStringView>
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "SnapshotSlot.h"
+
+// Развёрнутые правила Barcode_Countries.txt: id страны для каждого префикса (0 — нет страны)
+struct CountryPrefixTable
+{
+    std::array<std::uint16_t, 1000> byPrefix3{};   // ключ — первые 3 цифры
+    std::array<std::uint16_t, 100> byPrefix2{};    // ключ — код ровно из 2 цифр (EAN-8)
+    std::vector<std::string> names;                 // интернированные названия, id = индекс + 1
+
+    static CountryPrefixTable parse(std::string_view text);
+};
+
+// Таблица префиксов GS1: всё пространство 000–999 раскладывается один раз
+// в плоский массив id стран, поиск страны — одно чтение из массива.
+// Таблица — неизменяемый снимок, reload() подменяет её без блокировки читателей
+class CountryCatalog
+{
+public:
+    static constexpr std::uint16_t kNoCountry = 0;
+
+    static CountryCatalog& instance();
+
+    CountryCatalog(const CountryCatalog&) = delete;
+    CountryCatalog& operator=(const CountryCatalog&) = delete;
+
+    // id страны по первым 2–3 цифрам штрих-кода (прочие символы пропускаются), kNoCountry — нет совпадения
+    std::uint16_t findId(std::string_view barcode);
+    std::uint16_t findId(QStringView barcode);
+
+    QString name(std::uint16_t id);
+    std::string nameUtf8(std::uint16_t id);
+
+    // Поиск и название за одно обращение к снимку (id не "переедет" при перезагрузке); пусто — нет совпадения
+    QString findName(QStringView barcode);
+    std::string findNameUtf8(std::string_view barcode);
+
+    // Сколько цифр в строке (не больше 3) — чтобы отличить "слишком короткий код" от "не найдено"
+    static int digitCount(QStringView barcode);
+
+    // Перестроить таблицу по текущим файлам и опубликовать; бросает FileException, старая таблица остаётся
+    void reload();
+
+private:
+    struct Index
+    {
+        CountryPrefixTable table;
+        std::vector<QString> names;
+    };
+
+    CountryCatalog() = default;
+
+    template <typename Text>
+    static std::uint16_t lookup(const Index& index, const Text& barcode);
+
+    static std::unique_ptr<const Index> buildIndex();
+    static CountryPrefixTable loadFromFile(const QString& filePath);
+
+    SnapshotSlot<Index> snapshot;
+};
+
+#endif // COUNTRYCATALOG_H
@@ -1,15 +1,68 @@
 #pragma once
 #include <opencv2/opencv.hpp>
+#include <array>
+#include <optional>
 #include <vector>
+#include "FrameContext.h"
+
+// Регион-кандидат с оценкой "похожести на штрих-код" (0 — не похож)
+struct CurvedRegion {
+    cv::Rect rect;
+    double score = 0.0;
+    double angle = 0.0;   // поворот в градусах (как у getRotationMatrix2D), после которого штрихи вертикальны
+};
 
 class CurvedBarcodeDetector {
 public:
-    std::vector<cv::Rect> detectCurvedBarcodesOptimized(const cv::Mat& frame) const;
+    // Поиск от грубого к точному по пирамиде кадра из контекста: кандидаты ищутся на самом грубом
+    // полезном уровне, их рамки уточняются на более точных уровнях только внутри кандидата.
+    // Регионы — в координатах кадра, в порядке убывания оценки текстуры, пересекающиеся подавлены.
+    // Повёрнутые коды находятся по гистограмме направлений градиента и несут угол поворота
+    std::vector<CurvedRegion> detectCurvedBarcodesOptimized(const FrameContext& frame) const;
+    // Переоценка кандидатов и сортировка по убыванию оценки (при равенстве — исходный порядок); угол сохраняется
+    std::vector<CurvedRegion> rankRegions(const FrameContext& frame, const std::vector<CurvedRegion>& regions) const;
+
+    // Стадии поиска по отдельности (их замеряет tools/CurvedMasksBench.cpp)
+    // Уровень пирамиды для поиска кандидатов — зависит от размера кадра
+    int detectionLevel(const cv::Size& frame_size) const;
+    // Маски для поиска контуров: адаптивный порог 21 и 31, Otsu, сильный градиент.
+    // Все четыре — за два прохода по серому кадру (интегральное изображение + гистограмма, затем маски)
+    std::array<cv::Mat, 4> computeBinaryMasks(const cv::Mat& gray) const;
+    // Кандидаты всех четырёх масок (в порядке масок); gradients — того же уровня пирамиды, что и маски
+    std::vector<CurvedRegion> contourCandidates(const std::array<cv::Mat, 4>& masks,
+                                                const FrameContext::Gradients& gradients) const;
 
 private:
-    std::vector<cv::Rect> extractRegionsFromContours(const cv::Mat& binary, const cv::Size& image_size) const;
+    cv::Rect refineRegion(const FrameContext& frame, cv::Rect rect, int level) const;
+    std::optional<cv::Rect> tightenRegion(const cv::Mat& roi) const;
+    // Интегральные изображения градиентов маски (Sobel 3x3): сумма и сумма квадратов по x и по y.
+    // Строятся один раз на маску, дальше среднее и разброс градиента в любом прямоугольнике — O(1)
+    struct GradientIntegrals {
+        cv::Mat sum_x;
+        cv::Mat sqsum_x;
+        cv::Mat sum_y;
+        cv::Mat sqsum_y;
+    };
+    GradientIntegrals computeGradientIntegrals(const cv::Mat& binary) const;
+    // Кандидаты маски с оценкой текстуры; не прошедшие проверку вертикальных штрихов
+    // проверяются по гистограмме направлений градиентов уровня поиска
+    std::vector<CurvedRegion> extractRegionsFromContours(const cv::Mat& binary, const cv::Size& image_size,
+                                                         const FrameContext::Gradients& gradients) const;
     bool isValidBarcodeRegionExtended(const cv::Rect& rect, const cv::Size& image_size, const std::vector<cv::Point>& contour) const;
     cv::Rect expandBarcodeRegion(const cv::Rect& original, const cv::Size& image_size) const;
-    std::vector<cv::Rect> removeDuplicateRegions(const std::vector<cv::Rect>& regions) const;
-    bool hasBarcodeTextureAdvanced(const cv::Mat& region) const;
+    // Подавление немаксимумов: от лучшей оценки к худшей, кандидат отбрасывается, если перекрыт
+    // уже принятым больше чем на 60% меньшей площади. Принятые лежат в равномерной сетке,
+    // поэтому проверяются только соседи по ячейкам
+    std::vector<CurvedRegion> suppressOverlappingRegions(std::vector<CurvedRegion> regions, const cv::Size& image_size) const;
+    // Оценка "полосатости" по вертикальным штрихам; 0 — текстура не похожа на штрих-код
+    double barcodeTextureScore(const GradientIntegrals& integrals, const cv::Rect& rect) const;
+    // Преобладающее направление штрихов: гистограмма направлений градиента по модулю 180°
+    // (36 корзин по 5°, вес — |gx| + |gy|). score — вес пика к весу перпендикулярного направления,
+    // 0 — выраженного направления нет
+    struct BarOrientation {
+        double angle = 0.0;
+        double score = 0.0;
+    };
+    BarOrientation dominantOrientation(const FrameContext::Gradients& gradients, const cv::Rect& rect) const;
+    double scoreRegion(const FrameContext& frame, const cv::Rect& rect, double angle) const;
 };
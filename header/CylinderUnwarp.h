@@ -0,0 +1,80 @@
+#pragma once
+#include <opencv2/opencv.hpp>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+
+// Геометрия кода в регионе: этикетка на цилиндре (бутылка, банка) сжимает штрихи к краям,
+// перспектива наклоняет их, изогнутая поверхность выгибает дугой.
+// Все параметры квантованы: похожие упаковки дают одинаковые параметры и общие таблицы remap
+struct UnwarpParams {
+    int width = 0;         // размер региона, кратен 8
+    int height = 0;
+    int wrapDegrees = 0;   // половина угла охвата цилиндра по ширине региона, шаг 5°
+    int shear = 0;         // смещение штрихов у верхнего края относительно середины, пиксели: линейная часть
+    int bow = 0;           // то же, квадратичная часть (дуга)
+
+    bool isIdentity() const { return wrapDegrees == 0 && shear == 0 && bow == 0; }
+    // Точка выпрямленного изображения -> точка исходного региона
+    cv::Point2f sourcePoint(cv::Point2f point) const;
+    std::uint64_t key() const;
+};
+
+// Оценка по краям штрихов серого региона (размер кратен 8): охват цилиндра — по тому,
+// при каком угле интервалы между краями в средней полосе лучше всего кратны общему модулю;
+// наклон и дуга — по сдвигу профилей горизонтального градиента полос относительно средней
+UnwarpParams estimateUnwarp(const cv::Mat& gray);
+
+// Таблицы cv::remap в формате с фиксированной точкой (CV_16SC2 + CV_16UC1)
+struct RemapTables {
+    cv::Mat map1;
+    cv::Mat map2;
+};
+
+// Ограниченный LRU-кэш таблиц remap по квантованным параметрам.
+// Повторные сканы одной и той же упаковки не пересчитывают таблицы. Потокобезопасен
+class UnwarpMapCache {
+public:
+    static constexpr std::size_t kDefaultCapacity = 32;
+
+    struct Stats {
+        std::uint64_t hits = 0;
+        std::uint64_t misses = 0;
+        std::size_t size = 0;
+        std::size_t capacity = 0;
+    };
+
+    static UnwarpMapCache& instance();
+
+    explicit UnwarpMapCache(std::size_t capacity = kDefaultCapacity);
+
+    UnwarpMapCache(const UnwarpMapCache&) = delete;
+    UnwarpMapCache& operator=(const UnwarpMapCache&) = delete;
+
+    std::shared_ptr<const RemapTables> tables(const UnwarpParams& params);
+    Stats stats() const;
+
+private:
+    struct Entry {
+        std::uint64_t key;
+        std::shared_ptr<const RemapTables> tables;
+    };
+
+    static std::shared_ptr<const RemapTables> build(const UnwarpParams& params);
+
+    const std::size_t capacity;
+
+    mutable std::mutex mutex;
+    std::list<Entry> entries;   // в начале — последние использованные
+    std::unordered_map<std::uint64_t, std::list<Entry>::iterator> byKey;
+
+    std::atomic<std::uint64_t> hitCount{0};
+    std::atomic<std::uint64_t> missCount{0};
+};
+
+// Выпрямленный регион того же размера; таблицы берутся из UnwarpMapCache::instance()
+cv::Mat unwarpRegion(const cv::Mat& gray, const UnwarpParams& params);
@@ -0,0 +1,21 @@
+#pragma once
+#include <opencv2/opencv.hpp>
+#include <optional>
+#include "BarcodeResult.h"
+
+// Собственный декодер EAN-13 / UPC-A / EAN-8 по строкам развёртки — пробуется раньше ZBar.
+// Строка бинаризуется векторно (AVX2 / SSE2, иначе скалярно), из переходов собираются
+// ширины полос и сравниваются с таблицами L/G/R; код принимается только с верной
+// контрольной цифрой и если он прочитан на нескольких строках.
+// UPC-A возвращается как EAN-13 с ведущим нулём
+class EanScanlineDecoder {
+public:
+    // Серое изображение (цветное переводится в серое); код читается в обоих направлениях.
+    // location — концы кода на строках, где он прочитан
+    std::optional<BarcodeResult> decode(const cv::Mat& image) const;
+    // Одна строка пикселей; location — начало и конец кода (y = 0)
+    std::optional<BarcodeResult> decodeRow(const unsigned char* row, int width) const;
+
+private:
+    static constexpr int kScanlines = 15;
+};
@@ -0,0 +1,70 @@
+#ifndef ENRICHMENTCACHE_H
+#define ENRICHMENTCACHE_H
+
+#include <atomic>
+#include <cstdint>
+#include <list>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include "BarcodeResult.h"
+
+// Ограниченный LRU-кэш обогащённых результатов (страна, производитель, товар),
+// ключ — тип кода + цифры. На кассе большая часть сканов — одни и те же несколько сотен GTIN,
+// повторный скан обходится без поиска по справочникам и перестроения строк.
+// Потокобезопасен; invalidate() вызывается при перезагрузке справочников
+class EnrichmentCache
+{
+public:
+    static constexpr std::size_t kDefaultCapacity = 1024;
+
+    struct Stats
+    {
+        std::uint64_t hits = 0;
+        std::uint64_t misses = 0;
+        std::size_t size = 0;
+        std::size_t capacity = 0;
+    };
+
+    static EnrichmentCache& instance();
+
+    explicit EnrichmentCache(std::size_t capacity = kDefaultCapacity);
+
+    EnrichmentCache(const EnrichmentCache&) = delete;
+    EnrichmentCache& operator=(const EnrichmentCache&) = delete;
+
+    // Попадание — копия basicResult с заполненными страной, производителем и товаром
+    std::optional<BarcodeResult> find(const BarcodeResult& basicResult);
+
+    // Поколение справочников: запоминается до обогащения и передаётся в insert,
+    // чтобы результат, посчитанный по старым справочникам, не попал в кэш после invalidate()
+    std::uint64_t generation() const { return currentGeneration.load(std::memory_order_acquire); }
+    void insert(const BarcodeResult& detailedResult, std::uint64_t generation);
+
+    void invalidate();
+    Stats stats() const;
+
+private:
+    struct Entry
+    {
+        std::string key;
+        std::string country;
+        std::string manufacturerCode;
+        std::string productCode;
+    };
+
+    static std::string makeKey(const BarcodeResult& result);
+
+    const std::size_t capacity;
+
+    mutable std::mutex mutex;
+    std::list<Entry> entries;   // в начале — последние использованные
+    std::unordered_map<std::string, std::list<Entry>::iterator> byKey;
+
+    std::atomic<std::uint64_t> currentGeneration{0};
+    std::atomic<std::uint64_t> hitCount{0};
+    std::atomic<std::uint64_t> missCount{0};
+};
+
+#endif // ENRICHMENTCACHE_H
@@ -0,0 +1,41 @@
+#pragma once
+#include <opencv2/opencv.hpp>
+#include <deque>
+#include <map>
+#include <mutex>
+
+// Общие данные одного кадра на всё сканирование: серое изображение, уровни пирамиды
+// и их градиенты Собеля считаются один раз и отдаются стадиям по ссылке.
+// Серый кадр принадлежит контексту (исходное изображение после конструктора не читается),
+// остальное строится лениво при первом запросе. Потокобезопасен: стадии в параллельном
+// режиме обращаются к одному контексту; возвращённые ссылки живут, пока жив контекст
+class FrameContext {
+public:
+    // Градиенты Собеля 3x3 (CV_16S) по горизонтали и вертикали
+    struct Gradients {
+        cv::Mat dx;
+        cv::Mat dy;
+    };
+
+    explicit FrameContext(const cv::Mat& image);
+
+    FrameContext(const FrameContext&) = delete;
+    FrameContext& operator=(const FrameContext&) = delete;
+
+    const cv::Mat& gray() const { return grayFrame; }
+    cv::Size size() const { return grayFrame.size(); }
+    // Представление серого кадра без копии; rect обрезается по границам кадра
+    cv::Mat grayRoi(const cv::Rect& rect) const;
+
+    // Уровень пирамиды: 0 — сам кадр, n — уменьшение в 2^n раз (pyrDown)
+    const cv::Mat& pyramidLevel(int level) const;
+    // Градиенты уровня пирамиды
+    const Gradients& levelGradients(int level) const;
+
+private:
+    cv::Mat grayFrame;
+
+    mutable std::mutex mutex;
+    mutable std::deque<cv::Mat> pyramid;   // deque: ссылки на уровни не портятся при достройке
+    mutable std::map<int, Gradients> levelGradientCache;
+};
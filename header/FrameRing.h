@@ -0,0 +1,92 @@
+#pragma once
+#include <opencv2/opencv.hpp>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+// Кольцо кадров камеры: один писатель (поток захвата) и любое число читателей.
+// Буферы слотов выделяются на первом кадре и дальше переиспользуются: кадр читается прямо в слот.
+// Читатель закрепляет последний опубликованный слот без копирования, пока жив FrameRef;
+// писатель пишет только в незакреплённые слоты, кроме последнего опубликованного. Без блокировок
+class FrameRing {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    static constexpr std::size_t kDefaultSlots = 4;
+
+private:
+    struct Slot {
+        cv::Mat image;
+        Clock::time_point capturedAt;
+        std::uint64_t sequence = 0;
+        std::atomic<std::uint32_t> pins{0};
+        std::atomic<bool> consumed{false};   // кадр хоть раз отдан читателю
+    };
+
+public:
+    // Закреплённый кадр; image() действителен, пока жив объект
+    class FrameRef {
+    public:
+        FrameRef() = default;
+        FrameRef(FrameRef&& other) noexcept : slot(other.slot) { other.slot = nullptr; }
+        FrameRef& operator=(FrameRef&& other) noexcept {
+            if (this != &other) {
+                release();
+                slot = other.slot;
+                other.slot = nullptr;
+            }
+            return *this;
+        }
+        FrameRef(const FrameRef&) = delete;
+        FrameRef& operator=(const FrameRef&) = delete;
+        ~FrameRef() { release(); }
+
+        const cv::Mat& image() const { return slot->image; }
+        Clock::time_point capturedAt() const { return slot->capturedAt; }
+        std::uint64_t sequence() const { return slot->sequence; }
+        explicit operator bool() const { return slot != nullptr; }
+
+    private:
+        friend class FrameRing;
+        explicit FrameRef(Slot* pinned) : slot(pinned) {}
+
+        void release() {
+            if (slot) slot->pins.fetch_sub(1, std::memory_order_release);
+            slot = nullptr;
+        }
+
+        Slot* slot = nullptr;
+    };
+
+    explicit FrameRing(std::size_t slotCount = kDefaultSlots);
+
+    FrameRing(const FrameRing&) = delete;
+    FrameRing& operator=(const FrameRing&) = delete;
+
+    // Писатель: слот для следующего кадра; nullptr — все слоты закреплены, кадр придётся пропустить
+    cv::Mat* beginWrite();
+    // Публикация слота из beginWrite; предыдущий кадр, не отданный ни одному читателю, считается пропущенным
+    void publish(Clock::time_point capturedAt);
+    // Кадр прочитан, но сохранить его некуда
+    void dropFrame() { droppedCount.fetch_add(1, std::memory_order_relaxed); }
+    // Писатель: после остановки камеры старый кадр больше не отдаётся (буферы остаются)
+    void reset();
+
+    // Читатель: последний опубликованный кадр; пустой FrameRef — кадров ещё не было
+    FrameRef latest() const;
+
+    std::uint64_t published() const { return publishedCount.load(std::memory_order_relaxed); }
+    std::uint64_t dropped() const { return droppedCount.load(std::memory_order_relaxed); }
+
+private:
+    const std::size_t slotCount;
+    std::unique_ptr<Slot[]> ring;
+    std::atomic<int> latestIndex{-1};
+    int writeIndex = -1;              // только писатель
+    std::uint64_t nextSequence = 0;   // только писатель
+
+    std::atomic<std::uint64_t> publishedCount{0};
+    std::atomic<std::uint64_t> droppedCount{0};
+};
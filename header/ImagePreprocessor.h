@@ -4,5 +4,7 @@
 class ImagePreprocessor {
 public:
     cv::Mat enhanceContrast(const cv::Mat& input) const;
+    // CLAHE прямо по серому изображению, без перехода в Lab
+    cv::Mat enhanceContrastGray(const cv::Mat& gray) const;
     cv::Mat enhanceSharpness(const cv::Mat& input, double strength) const;
 };
@@ -0,0 +1,59 @@
+#pragma once
+#include <QObject>
+#include <QString>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include "BarcodeReader.h"
+#include "BarcodeReader2D.h"
+#include "BarcodeResult.h"
+
+class CameraManager;
+
+// Распознавание живого потока камеры в своём потоке: берётся только самый свежий кадр кольца
+// (без копии), кадры, пришедшие за время распознавания, пропускаются. Декодеры — собственные,
+// с декодерами окна не пересекаются. Результаты и статистика уходят сигналами (очередное соединение)
+class LiveDecodeWorker : public QObject
+{
+    Q_OBJECT
+public:
+    using Clock = std::chrono::steady_clock;
+
+    // Срок на один кадр: дольше распознавать смысла нет — кадр уже устарел
+    static constexpr std::chrono::milliseconds kFrameBudget{300};
+
+    explicit LiveDecodeWorker(CameraManager* camera, QObject* parent = nullptr);
+    ~LiveDecodeWorker() override;
+
+    void start();
+    // Дожидается текущего кадра; после возврата закреплённых кадров кольца не остаётся
+    void stop();
+    bool isRunning() const { return running.load(std::memory_order_relaxed); }
+
+    // Новый кадр в кольце; вызывается напрямую из потока захвата (CameraManager::frameCaptured)
+    void frameAvailable();
+
+signals:
+    // latencyMs — от захвата кадра до готового результата
+    void barcodeDecoded(const BarcodeResult& result, const QString& decoderName, double latencyMs);
+    // Раз в секунду: кадров распознано в секунду, средняя задержка, пропущено устаревших кадров за окно
+    void statsUpdated(double decodeFps, double latencyMs, quint64 staleFrames);
+
+private:
+    void decodeLoop();
+    // Сначала 1D (со сроком, без исключений), затем 2D
+    bool decodeFrame(const cv::Mat& image, BarcodeResult& result, QString& decoderName);
+
+    CameraManager* camera;
+    BarcodeReader reader1D;
+    BarcodeReader2D reader2D;
+
+    std::thread worker;
+    std::atomic<bool> running{false};
+    std::mutex mutex;
+    std::condition_variable wake;
+    bool frameSignalled = false;
+};
@@ -20,7 +20,7 @@ public:
 
     bool isValid() const;
 
-    // 📂 Новый метод: поиск производителя по коду штрих-кода напрямую в файле
+    // Поиск производителя по коду или целому штрих-коду (самый длинный префикс GS1 из каталога)
     static QString findManufacturerByCode(const QString& code);
 };
 
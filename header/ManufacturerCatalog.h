@@ -0,0 +1,83 @@
+#ifndef MANUFACTURERCATALOG_H
+#define MANUFACTURERCATALOG_H
+
+#include <QString>
+#include <QStringView>
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <string_view>
+#include <vector>
+#include "SnapshotSlot.h"
+
+class CompiledCatalog;
+
+// Каталог префиксов производителей GS1 (Barcode_Manufacturers.txt).
+// Префикс компании в GS1 имеет переменную длину (6–10 цифр вместе с префиксом страны),
+// поэтому все префиксы собираются в цифровое дерево, и поиск за один проход по цифрам
+// штрих-кода находит самый длинный совпавший префикс.
+// Дерево — неизменяемый снимок, reload() подменяет его без блокировки читателей
+class ManufacturerCatalog
+{
+public:
+    struct Match
+    {
+        QString description;    // пусто — ни один префикс не подошёл
+        int prefixLength = 0;   // сколько цифр кода заняло совпадение
+    };
+
+    static ManufacturerCatalog& instance();
+
+    ManufacturerCatalog(const ManufacturerCatalog&) = delete;
+    ManufacturerCatalog& operator=(const ManufacturerCatalog&) = delete;
+
+    // Самый длинный префикс из каталога, с которого начинается код; разбор останавливается на первой не цифре
+    Match find(std::string_view barcode);
+    Match find(QStringView barcode);
+
+    // Пакетный поиск за одно обращение к снимку
+    void find(std::span<const std::string_view> barcodes, std::span<Match> matches);
+
+    std::size_t size();
+
+    // Перестроить дерево по текущим файлам и опубликовать; бросает FileException, старое дерево остаётся
+    void reload();
+
+private:
+    // Узел дерева: дети одного узла лежат подряд, номер ребёнка — число установленных битов маски до цифры
+    struct Node
+    {
+        std::uint16_t childMask = 0;
+        std::uint32_t firstChild = 0;
+        std::uint32_t entry = 0;   // номер описания + 1, 0 — префикс здесь не заканчивается
+    };
+
+    struct Prefix
+    {
+        std::string digits;
+        std::uint32_t entry;
+    };
+
+    struct Index
+    {
+        std::vector<Node> nodes;
+        std::vector<QString> descriptions;
+        std::size_t prefixCount = 0;
+        std::shared_ptr<const CompiledCatalog> compiled;   // если задан — описания берутся из него
+    };
+
+    ManufacturerCatalog() = default;
+
+    template <typename Text>
+    static Match lookup(const Index& index, const Text& barcode);
+
+    static std::unique_ptr<const Index> buildIndex();
+    static void loadFromFile(const QString& filePath, Index& index, std::vector<Prefix>& prefixes);
+    static void buildTrie(std::vector<Prefix>& prefixes, std::vector<Node>& nodes);
+    static void buildNode(const std::vector<Prefix>& prefixes, std::size_t begin, std::size_t end,
+                          std::size_t depth, std::uint32_t nodeIndex, std::vector<Node>& nodes);
+
+    SnapshotSlot<Index> snapshot;
+};
+
+#endif // MANUFACTURERCATALOG_H
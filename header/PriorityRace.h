@@ -0,0 +1,88 @@
+#pragma once
+#include <QThreadPool>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <utility>
+#include <vector>
+#include "CancellationToken.h"
+
+// Гонка задач с приоритетом: все задачи стартуют на пуле одновременно,
+// побеждает задача с наименьшим индексом среди давших результат — как при последовательном проходе.
+// Успех задачи отменяет только менее приоритетные; ответ готов, как только все более
+// приоритетные задачи завершились без результата. Затем отменяются все оставшиеся.
+//
+// task(index, cancel) -> std::optional<Result>, должна регулярно проверять cancel.
+// waitForAll = false: отменённые задачи дорабатывают в фоне, поэтому task и parent
+// не должны ссылаться на то, что умрёт после возврата (parent — nullptr или долгоживущий токен).
+template<typename Result, typename Task>
+std::optional<std::pair<int, Result>> runPriorityRace(QThreadPool& pool, int taskCount, Task task,
+                                                      const CancellationToken* parent, bool waitForAll) {
+    struct RaceState {
+        RaceState(int count, const CancellationToken* parent)
+            : finished(count, false), results(count), running(count) {
+            for (int index = 0; index < count; ++index) tokens.emplace_back(parent);
+        }
+
+        std::mutex mutex;
+        std::condition_variable changed;
+        std::deque<CancellationToken> tokens;
+        std::vector<bool> finished;
+        std::vector<std::optional<Result>> results;
+        int running;
+    };
+
+    if (taskCount <= 0) return std::nullopt;
+
+    auto state = std::make_shared<RaceState>(taskCount, parent);
+    auto sharedTask = std::make_shared<Task>(std::move(task));
+
+    for (int index = 0; index < taskCount; ++index) {
+        pool.start([state, sharedTask, index] {
+            std::optional<Result> result;
+            try {
+                result = (*sharedTask)(index, state->tokens[index]);
+            } catch (const std::exception& e) {
+                std::cerr << "Ошибка параллельной задачи " << index + 1 << ": " << e.what() << std::endl;
+            }
+
+            {
+                std::lock_guard lock(state->mutex);
+                if (result) {
+                    for (int lower = index + 1; lower < static_cast<int>(state->tokens.size()); ++lower) {
+                        state->tokens[lower].cancel();
+                    }
+                }
+                state->results[index] = std::move(result);
+                state->finished[index] = true;
+                --state->running;
+            }
+            state->changed.notify_all();
+        });
+    }
+
+    std::unique_lock lock(state->mutex);
+    int winner = -1;
+    state->changed.wait(lock, [&] {
+        for (int index = 0; index < taskCount; ++index) {
+            if (!state->finished[index]) return false;
+            if (state->results[index]) {
+                winner = index;
+                return true;
+            }
+        }
+        return true;
+    });
+
+    for (auto& token : state->tokens) token.cancel();
+    if (waitForAll) {
+        state->changed.wait(lock, [&] { return state->running == 0; });
+    }
+
+    if (winner < 0) return std::nullopt;
+    return std::make_pair(winner, std::move(*state->results[winner]));
+}
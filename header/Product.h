@@ -20,7 +20,7 @@ public:
 
     bool isValid() const;
 
-    // 📂 Новый метод: поиск товара по штрих-коду напрямую в файле
+    // 📂 Поиск товара по штрих-коду (через индекс ProductCatalog)
     static QString findProductByBarcode(const QString& barcode);
 };
 
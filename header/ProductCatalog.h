@@ -0,0 +1,68 @@
+#ifndef PRODUCTCATALOG_H
+#define PRODUCTCATALOG_H
+
+#include <QString>
+#include <QStringView>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include "SnapshotSlot.h"
+
+class CompiledCatalog;
+
+// Индекс каталога товаров: Barcode_Products.txt читается один раз,
+// дальше поиск идёт по хеш-таблице с ключом "упакованный GTIN" (O(1), без выделения памяти).
+// Если рядом лежит скомпилированный Barcode_Catalog.bin — поиск идёт по нему без разбора текста.
+// Индекс — неизменяемый снимок: reload() строит новый и подменяет его, не блокируя читателей
+class ProductCatalog
+{
+public:
+    static ProductCatalog& instance();
+
+    ProductCatalog(const ProductCatalog&) = delete;
+    ProductCatalog& operator=(const ProductCatalog&) = delete;
+
+    // Упаковка GTIN в 64 бита: число в младших битах, длина — в старших,
+    // чтобы "0123" и "123" давали разные ключи. Не цифры или > 14 цифр — nullopt
+    static std::optional<std::uint64_t> packGtin(std::string_view barcode);
+    static std::optional<std::uint64_t> packGtin(QStringView barcode);
+    // Обратное преобразование: цифры с ведущими нулями
+    static std::string unpackGtin(std::uint64_t key);
+    // Ключ товара: packGtin, но 12-значный UPC-A приводится к GTIN-13 с ведущим нулём —
+    // декодеры отдают UPC-A как EAN-13, а в справочнике он может быть записан 12 цифрами
+    static std::optional<std::uint64_t> productKey(std::string_view barcode);
+    static std::optional<std::uint64_t> productKey(QStringView barcode);
+
+    // Готовое описание товара или пустая строка, если товара нет в каталоге; key — из productKey
+    QString find(std::uint64_t key);
+    QString find(std::string_view barcode);
+    QString find(QStringView barcode);
+
+    // Пакетный поиск за одно обращение к снимку; ключи — по возрастанию, ненайденные описания остаются пустыми
+    void find(std::span<const std::uint64_t> sortedKeys, std::span<QString> descriptions);
+
+    std::size_t size();
+
+    // Перестроить индекс по текущим файлам и опубликовать; бросает FileException, старый индекс остаётся
+    void reload();
+
+private:
+    struct Index
+    {
+        std::unordered_map<std::uint64_t, QString> entries;
+        std::shared_ptr<const CompiledCatalog> compiled;
+    };
+
+    ProductCatalog() = default;
+
+    static std::unique_ptr<const Index> buildIndex();
+    static void loadFromFile(const QString& filePath, Index& index);
+
+    SnapshotSlot<Index> snapshot;
+};
+
+#endif // PRODUCTCATALOG_H
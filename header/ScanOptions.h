@@ -0,0 +1,36 @@
+#pragma once
+#include <chrono>
+#include <string>
+#include <vector>
+#include "BarcodeResult.h"
+
+// Параметры одного вызова BarcodeReader::decode
+struct ScanOptions {
+    using Clock = std::chrono::steady_clock;
+
+    // Срок, после которого распознавание прекращается (по умолчанию — без ограничения)
+    Clock::time_point deadline = Clock::time_point::max();
+
+    static ScanOptions withBudget(std::chrono::milliseconds budget) {
+        ScanOptions options;
+        options.deadline = Clock::now() + budget;
+        return options;
+    }
+};
+
+enum class ScanStatus { Decoded, NotFound, TimedOut };
+enum class StageStatus { NotStarted, Running, Completed, Decoded, TimedOut, Cancelled };
+
+struct StageReport {
+    std::string name;
+    StageStatus status = StageStatus::NotStarted;
+    double milliseconds = 0.0;
+};
+
+// Итог вызова: результат (если распознан) и докуда дошла каждая стадия конвейера
+struct ScanReport {
+    ScanStatus status = ScanStatus::NotFound;
+    BarcodeResult result;
+    std::vector<StageReport> stages;   // в порядке приоритета
+    double elapsedMs = 0.0;
+};
@@ -1,19 +1,47 @@
 #ifndef SMARTDECODER_H
 #define SMARTDECODER_H
 
+#include "CancellationToken.h"
 #include "ImagePreprocessor.h"
 #include "ZBarDecoder.h"
 #include <opencv2/opencv.hpp>
+#include <optional>
 #include <string>
+#include <string_view>
+#include <vector>
+
+// Варианты предобработки региона; каждый строится только если предыдущие не распознались
+enum class PreprocessVariant {
+    Raw,        // регион как есть (в оттенках серого)
+    Unwarped,   // выпрямленный регион — только если найден цилиндр, наклон или дуга штрихов
+    Upscaled,   // увеличенный регион — только для узких регионов
+    Contrast,   // CLAHE
+    Sharpened   // нерезкое маскирование
+};
 
 class SmartDecoder {
 public:
     SmartDecoder(ImagePreprocessor& preprocessor, ZBarDecoder& decoder);
-    std::string smartDecodeWithUnwarp(const cv::Mat& frame, const cv::Rect& rect);
+    // angle — поворот региона (CurvedRegion::angle), делается один раз до всех вариантов.
+    // cancel проверяется между вариантами предобработки; контур результата — в координатах кадра
+    std::optional<BarcodeResult> smartDecodeWithUnwarp(const cv::Mat& frame, const cv::Rect& rect, double angle,
+                                                       const CancellationToken* cancel = nullptr);
+    // Все символы региона из первого варианта, где ZBar что-то нашёл; контуры — в координатах кадра
+    std::vector<ZBarSymbol> decodeAllWithUnwarp(const cv::Mat& frame, const cv::Rect& rect, double angle,
+                                                const CancellationToken* cancel = nullptr);
+
+    void setVariantOrder(std::vector<PreprocessVariant> order) { variantOrder = std::move(order); }
+    const std::vector<PreprocessVariant>& getVariantOrder() const { return variantOrder; }
+
+    // Порядок вариантов из строки вида "raw,unwarped,upscaled,contrast,sharpened"; неизвестные имена пропускаются
+    static std::vector<PreprocessVariant> parseVariantOrder(std::string_view text);
+    // Порядок по умолчанию: переменная окружения BARCODE_VARIANT_ORDER или raw,unwarped,upscaled,contrast,sharpened
+    static const std::vector<PreprocessVariant>& defaultVariantOrder();
 
 private:
     ImagePreprocessor& preprocessor;
     ZBarDecoder& decoder;
+    std::vector<PreprocessVariant> variantOrder;
 };
 
 #endif // SMARTDECODER_H
@@ -0,0 +1,97 @@
+// SnapshotSlot.h
+#pragma once
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+// Ячейка с неизменяемым снимком данных в стиле RCU.
+// Читатели не берут блокировок: регистрируются в счётчике текущей эпохи и читают указатель.
+// Писатель атомарно подменяет указатель, переключает эпоху и удаляет старый снимок
+// только после того, как его дочитали все читатели прошлой эпохи.
+template<typename T>
+class SnapshotSlot {
+public:
+    // Доступ к снимку на время жизни объекта; снимок не удалится, пока guard жив
+    class ReadGuard {
+    public:
+        ReadGuard(ReadGuard&& other) noexcept
+            : slot(other.slot), epoch(other.epoch), value(other.value) {
+            other.slot = nullptr;
+        }
+        ReadGuard(const ReadGuard&) = delete;
+        ReadGuard& operator=(const ReadGuard&) = delete;
+        ReadGuard& operator=(ReadGuard&&) = delete;
+
+        ~ReadGuard() {
+            if (slot) slot->readers[epoch].fetch_sub(1, std::memory_order_release);
+        }
+
+        const T* get() const { return value; }
+        const T* operator->() const { return value; }
+        const T& operator*() const { return *value; }
+        explicit operator bool() const { return value != nullptr; }
+
+    private:
+        friend class SnapshotSlot;
+        ReadGuard(const SnapshotSlot* owner, unsigned readerEpoch, const T* snapshot)
+            : slot(owner), epoch(readerEpoch), value(snapshot) {}
+
+        const SnapshotSlot* slot;
+        unsigned epoch;
+        const T* value;
+    };
+
+    SnapshotSlot() = default;
+    SnapshotSlot(const SnapshotSlot&) = delete;
+    SnapshotSlot& operator=(const SnapshotSlot&) = delete;
+
+    ~SnapshotSlot() { delete current.load(); }
+
+    bool hasValue() const { return current.load(std::memory_order_acquire) != nullptr; }
+
+    ReadGuard read() const {
+        for (;;) {
+            const unsigned readerEpoch = epoch.load();
+            readers[readerEpoch].fetch_add(1);
+            // Эпоха могла смениться между чтением и регистрацией — тогда повторяем
+            if (epoch.load() == readerEpoch) {
+                return ReadGuard(this, readerEpoch, current.load());
+            }
+            readers[readerEpoch].fetch_sub(1);
+        }
+    }
+
+    // Первое обращение: снимок строится под мьютексом писателя (create может бросить исключение)
+    template<typename Factory>
+    ReadGuard readOrCreate(Factory&& create) {
+        if (!hasValue()) {
+            std::lock_guard lock(writerMutex);
+            if (!current.load(std::memory_order_relaxed)) {
+                current.store(create().release(), std::memory_order_release);
+            }
+        }
+        return read();
+    }
+
+    // Публикация нового снимка. Блокирует только писателя — до конца чтения старого снимка
+    void publish(std::unique_ptr<const T> next) {
+        std::lock_guard lock(writerMutex);
+        const T* previous = current.exchange(next.release());
+
+        const unsigned previousEpoch = epoch.load();
+        epoch.store(previousEpoch ^ 1u);
+        while (readers[previousEpoch].load() != 0) {
+            std::this_thread::yield();
+        }
+        delete previous;
+    }
+
+private:
+    std::atomic<const T*> current{nullptr};
+    std::atomic<unsigned> epoch{0};
+    mutable std::array<std::atomic<std::uint32_t>, 2> readers{};
+    std::mutex writerMutex;
+};
@@ -1,19 +1,47 @@
 #pragma once
 #include <opencv2/opencv.hpp>
 #include <zbar.h>
+#include <optional>
 #include <string>
+#include <vector>
 #include "BarcodeResult.h"
+#include "EanScanlineDecoder.h"
 #include "DecodeException.h"
 #include "BarcodeException.h"
 
+// Символ, найденный ZBar: тип, данные и контур в координатах переданного изображения
+struct ZBarSymbol {
+    std::string type;
+    std::string data;
+    std::vector<cv::Point> location;
+};
+
 class ZBarDecoder {
 private:
     zbar::ImageScanner zbar_scanner;
+    // Для выпрямленных полос: только горизонтальные строки развёртки, каждая четвёртая
+    zbar::ImageScanner strip_scanner;
+    EanScanlineDecoder eanDecoder;
+
+    // Сканирование без выделения памяти на каждый вызов: буферы и zbar::Image — на поток.
+    // visit(symbol, scale) вызывается для каждого символа; scale — увеличение маленького региона
+    template<typename Visit>
+    void scanSymbols(zbar::ImageScanner& scanner, const cv::Mat& roi, Visit&& visit);
+    std::optional<BarcodeResult> decodeBest(zbar::ImageScanner& scanner, const cv::Mat& roi);
 public:
     ZBarDecoder(); // Явное объявление конструктора
     ~ZBarDecoder() = default; // И деструктора тоже
 
+    // Сначала собственный декодер EAN/UPC, ZBar — для остальных символик и трудных кадров.
+    // Результат — сразу структурой, с контуром в координатах roi
+    std::optional<BarcodeResult> decodeBestWithZBar(const cv::Mat& roi);
+    // То же для полосы с вертикальными штрихами (BarcodeDetectorOpenCV::rectify) — разреженным сканом
+    std::optional<BarcodeResult> decodeStrip(const cv::Mat& strip);
+    // То же строкой "тип: данные" (пустая — не распознан)
     std::string decodeWithZBar(const cv::Mat& roi);
+    // Все символы изображения за один проход сканера
+    std::vector<ZBarSymbol> decodeAllWithZBar(const cv::Mat& roi);
+    static BarcodeResult toBarcodeResult(const ZBarSymbol& symbol);
     std::string filterBarcodeResult(const std::string& result);
     BarcodeResult parseZBarResult(std::string_view zbarResult);
 };
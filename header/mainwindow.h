@@ -17,13 +17,14 @@
 #include <vector>
 
 #include "CameraManager.h"
+#include "CatalogWatcher.h"
+#include "LiveDecodeWorker.h"
 #include "ImageManager.h"
 #include "Decoder.h"
 #include "BarcodeReader.h"
 #include "BarcodeReader2D.h"
 #include "BarcodeResult.h"
 #include "WebServer.h"
-#include "ImageBuffer.h"
 #include "BarcodeException.h"
 class MainWindow : public QMainWindow
 {
@@ -41,21 +42,30 @@ private slots:
     void toggleCamera();
 
     // CameraManager
-    void onCameraFrameReady(const cv::Mat& frame);
+    void onCameraFrameReady();
     void onCameraStarted();
     void onCameraStopped();
     void onCameraError(const QString& error);
 
+    // LiveDecodeWorker
+    void onLiveBarcodeDecoded(const BarcodeResult& result, const QString& decoderName, double latencyMs);
+    void onLiveDecodeStats(double decodeFps, double latencyMs, quint64 staleFrames);
+
     // ImageManager
     void onImageLoaded(const QString& filePath, const QSize& size);
     void onImageCleared();
     void onImageError(const QString& error);
 
+    // CatalogWatcher
+    void onCatalogReloaded(const QString& fileName, qint64 buildMs, qint64 latencyMs);
+    void onCatalogReloadFailed(const QString& fileName, const QString& error);
+
 private:
     // --- Менеджеры --- (объявляем ПЕРВЫМИ)
     CameraManager* cameraManager;
     ImageManager* imageManager;
-    ImageBuffer<cv::Mat> cameraBuffer{10};
+    CatalogWatcher* catalogWatcher;
+    LiveDecodeWorker* liveDecoder;
 
     // --- UI ---
     QWidget* centralWidget;                             // 4
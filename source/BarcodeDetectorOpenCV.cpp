@@ -1,8 +1,40 @@
 #include "BarcodeDetectorOpenCV1D.h"
+#include <algorithm>
+#include <cmath>
 #include <iostream>
 
+namespace {
+
+// OpenCV называет символики EAN_13, UPC_A...; результаты ZBar — EAN-13, UPC-A.
+// Приводим к одному виду, чтобы обогащение, кэш и схлопывание повторов не различали источник
+std::string zbarTypeName(std::string opencvType) {
+    std::replace(opencvType.begin(), opencvType.end(), '_', '-');
+    return opencvType;
+}
+
+// Высота полосы: 40 строк хватает для нескольких строк развёртки и не заставляет ZBar увеличивать её
+constexpr int kStripHeight = 40;
+constexpr int kMinStripWidth = 160;
+constexpr int kMaxStripWidth = 1024;
+// Запас вдоль кода с каждой стороны — тихая зона, которую контур OpenCV часто срезает
+constexpr float kQuietZonePadding = 0.1f;
+
+float length(const cv::Point2f& vector) {
+    return std::hypot(vector.x, vector.y);
+}
+
+} // namespace
+
 std::vector<std::vector<cv::Point>> BarcodeDetectorOpenCV::detectWithOpenCV(const cv::Mat& frame) const{
     std::vector<std::vector<cv::Point>> polygons;
+    for (auto& detection : detectAndDecode(frame)) {
+        polygons.push_back(std::move(detection.polygon));
+    }
+    return polygons;
+}
+
+std::vector<OpenCVDetection> BarcodeDetectorOpenCV::detectAndDecode(const cv::Mat& frame) const{
+    std::vector<OpenCVDetection> detections;
     std::vector<cv::Point> corners;
     std::vector<std::string> decoded_info;
     std::vector<std::string> decoded_type;
@@ -11,11 +43,17 @@ std::vector<std::vector<cv::Point>> BarcodeDetectorOpenCV::detectWithOpenCV(cons
         bool detected = opencv_detector.detectAndDecodeWithType(frame, decoded_info, decoded_type, corners);
 
         if (detected && !corners.empty() && corners.size() % 4 == 0) {
-            for (int i = 0; i < (int)corners.size(); i += 4) {
-                if (i + 3 < corners.size()) {
-                    std::vector<cv::Point> polygon = { corners[i], corners[i + 1], corners[i + 2], corners[i + 3] };
-                    polygons.push_back(polygon);
+            for (int i = 0; i + 3 < (int)corners.size(); i += 4) {
+                OpenCVDetection detection;
+                detection.polygon = { corners[i], corners[i + 1], corners[i + 2], corners[i + 3] };
+
+                const std::size_t index = i / 4;
+                if (index < decoded_info.size() && !decoded_info[index].empty()) {
+                    detection.data = decoded_info[index];
+                    detection.type = index < decoded_type.size() ? zbarTypeName(decoded_type[index]) : "";
+                    std::cout << "OpenCV decoded: " << detection.type << " - " << detection.data << std::endl;
                 }
+                detections.push_back(std::move(detection));
             }
         }
     }
@@ -26,7 +64,57 @@ std::vector<std::vector<cv::Point>> BarcodeDetectorOpenCV::detectWithOpenCV(cons
     }
 
 
-    return polygons;
+    return detections;
 }
 
+std::vector<cv::Point> RectifiedStrip::mapToFrame(const std::vector<cv::Point>& points) const{
+    if (points.empty()) return {};
 
+    std::vector<cv::Point2f> source(points.begin(), points.end());
+    std::vector<cv::Point2f> mapped;
+    cv::perspectiveTransform(source, mapped, toFrame);
+
+    std::vector<cv::Point> result;
+    result.reserve(mapped.size());
+    for (const auto& point : mapped) result.emplace_back(cvRound(point.x), cvRound(point.y));
+    return result;
+}
+
+std::optional<RectifiedStrip> BarcodeDetectorOpenCV::rectify(const cv::Mat& gray, const std::vector<cv::Point>& polygon) {
+    if (polygon.size() != 4) return std::nullopt;
+
+    // Углы по порядку обхода; первая сторона — длинная
+    cv::Point2f corners[4];
+    const bool first_side_longer = length(cv::Point2f(polygon[1] - polygon[0])) >= length(cv::Point2f(polygon[2] - polygon[1]));
+    for (int i = 0; i < 4; ++i) {
+        corners[i] = cv::Point2f(polygon[(i + (first_side_longer ? 0 : 1)) % 4]);
+    }
+
+    const float code_length = std::max(length(corners[1] - corners[0]), length(corners[2] - corners[3]));
+    const float code_height = std::max(length(corners[3] - corners[0]), length(corners[2] - corners[1]));
+    if (code_length < 8.0f || code_height < 2.0f) return std::nullopt;
+
+    // Края вдоль кода раздвигаются на тихую зону
+    const cv::Point2f top_pad = (corners[1] - corners[0]) * kQuietZonePadding;
+    const cv::Point2f bottom_pad = (corners[2] - corners[3]) * kQuietZonePadding;
+    const cv::Point2f source[4] = { corners[0] - top_pad, corners[1] + top_pad, corners[2] + bottom_pad, corners[3] - bottom_pad };
+
+    const int width = std::clamp(cvRound(code_length * (1.0f + 2.0f * kQuietZonePadding)), kMinStripWidth, kMaxStripWidth);
+    const cv::Point2f target[4] = { cv::Point2f(0.0f, 0.0f), cv::Point2f(width - 1.0f, 0.0f),
+                                    cv::Point2f(width - 1.0f, kStripHeight - 1.0f), cv::Point2f(0.0f, kStripHeight - 1.0f) };
+
+    RectifiedStrip strip;
+    cv::warpPerspective(gray, strip.image, cv::getPerspectiveTransform(source, target),
+                        cv::Size(width, kStripHeight), cv::INTER_LINEAR, cv::BORDER_REPLICATE);
+    strip.toFrame = cv::getPerspectiveTransform(target, source);
+    return strip;
+}
+
+BarcodeResult BarcodeDetectorOpenCV::toBarcodeResult(const OpenCVDetection& detection) {
+    BarcodeResult result;
+    result.type = detection.type;
+    result.digits = detection.data;
+    result.fullResult = detection.type + ": " + detection.data;
+    result.location = detection.polygon;
+    return result;
+}
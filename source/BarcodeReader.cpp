@@ -1,17 +1,65 @@
-﻿#include "BarcodeReader.h"
+#include "BarcodeReader.h"
 #include "Country.h"
-#include "Manufacturer.h"
+#include "CountryCatalog.h"
+#include "ManufacturerCatalog.h"
 #include "Product.h"
+#include <QThread>
+#include <algorithm>
+#include <chrono>
 #include <iostream>
 #include <fstream>
+#include <numeric>
 
 #include "ImageLoadException.h"
 #include "DecodeException.h"
+#include "EnrichmentCache.h"
 #include "FileException.h"
+#include "PriorityRace.h"
+#include "ProductCatalog.h"
+
+namespace {
+
+// Тексты для пользователя — те же, что дают findProduct / findManufacturer по одному коду
+std::string productText(const QString& description, std::string_view barcode) {
+    return description.isEmpty() ? "Неизвестный товар (" + std::string(barcode) + ")" : description.toStdString();
+}
+
+std::string manufacturerText(const ManufacturerCatalog::Match& match) {
+    return match.description.isEmpty() ? "Неизвестный производитель" : match.description.toStdString();
+}
+
+// Результат с ошибкой чтения справочника не кэшируется: после исправления файла он должен пересчитаться
+bool hasLookupError(const BarcodeResult& result) {
+    constexpr std::string_view errorPrefix = "Ошибка чтения файла";
+    return result.country.starts_with(errorPrefix) || result.manufacturerCode.starts_with(errorPrefix)
+           || result.productCode.starts_with(errorPrefix);
+}
+
+void cacheDetailedResult(const BarcodeResult& detailedResult, std::uint64_t generation) {
+    if (!hasLookupError(detailedResult)) EnrichmentCache::instance().insert(detailedResult, generation);
+}
+
+// Контур с запасом: разные стадии находят один и тот же код по разным строкам развёртки
+cv::Rect paddedBounds(const std::vector<cv::Point>& location) {
+    cv::Rect bounds = cv::boundingRect(location);
+    const int pad = std::max(16, std::max(bounds.width, bounds.height) / 4);
+    return cv::Rect(bounds.x - pad, bounds.y - pad, bounds.width + 2 * pad, bounds.height + 2 * pad);
+}
+
+// Тот же символ: совпадают тип и данные, а контуры (если известны) пересекаются
+bool isSameSymbol(const BarcodeResult& a, const BarcodeResult& b) {
+    if (a.type != b.type || a.digits != b.digits) return false;
+    if (a.location.empty() || b.location.empty()) return true;
+    return (paddedBounds(a.location) & paddedBounds(b.location)).area() > 0;
+}
+
+} // namespace
 
 BarcodeReader::BarcodeReader()
     : smartDecoder(preprocessor, zbarDecoder) { // Правильная инициализация SmartDecoder
     // настройка ZBar и загрузка данных
+    stagePool.setMaxThreadCount(kStageCount);
+    regionPool.setMaxThreadCount(std::max(1, QThread::idealThreadCount()));
 }
 
 BarcodeReader::~BarcodeReader() = default;
@@ -30,72 +78,319 @@ BarcodeResult BarcodeReader::decode(const std::string& filename) {
 
 
 BarcodeResult BarcodeReader::advancedDecode(const cv::Mat& image) {
+    return resultOrThrow(runScan(image, ScanOptions{}, concurrentStages));
+}
 
-    BarcodeResult result;
-    result.type = "Неизвестно";
+BarcodeResult BarcodeReader::advancedDecodeConcurrent(const cv::Mat& image) {
+    return resultOrThrow(runScan(image, ScanOptions{}, true));
+}
 
+ScanReport BarcodeReader::decode(const cv::Mat& image, const ScanOptions& options) {
+    return runScan(image, options, concurrentStages);
+}
+
+BarcodeResult BarcodeReader::resultOrThrow(const ScanReport& report) {
+    if (report.status != ScanStatus::Decoded) {
+        throw DecodeException("Штрих-код не распознан");
+    }
+    return report.result;
+}
+
+// Состояние стадий одного прохода; в параллельном режиме отменённые стадии могут
+// дописать его уже после возврата, поэтому журнал живёт в shared_ptr
+struct BarcodeReader::StageLog {
+    std::mutex mutex;
+    std::vector<StageReport> stages{ { "OpenCV + ZBar" }, { "Изогнутые регионы" }, { "Полный кадр ZBar" } };
+
+    void update(DecodeStage stage, StageStatus status, double milliseconds = 0.0) {
+        std::lock_guard lock(mutex);
+        stages[static_cast<int>(stage)].status = status;
+        stages[static_cast<int>(stage)].milliseconds = milliseconds;
+    }
+    std::vector<StageReport> snapshot() {
+        std::lock_guard lock(mutex);
+        return stages;
+    }
+};
+
+ScanReport BarcodeReader::runScan(const cv::Mat& image, const ScanOptions& options, bool concurrent) {
     if (image.empty()) {
         throw DecodeException("Пустое изображение для декодирования");
     }
 
-    std::cout << "=== НАЧАЛО СКАНИРОВАНИЯ ===" << std::endl;
+    const auto started = std::chrono::steady_clock::now();
+    std::cout << (concurrent ? "=== НАЧАЛО СКАНИРОВАНИЯ (параллельно) ===" : "=== НАЧАЛО СКАНИРОВАНИЯ ===") << std::endl;
     std::cout << "Размер изображения: " << image.cols << "x" << image.rows << std::endl;
 
-    cv::Mat frame = image.clone();
+    // Серый кадр, пирамида и градиенты — один раз на сканирование, общие для всех стадий.
+    // Контекст владеет своими данными, поэтому копия исходного кадра не нужна
+    auto frame = std::make_shared<const FrameContext>(image);
+    auto log = std::make_shared<StageLog>();
+    std::optional<BarcodeResult> parsedResult;
+
+    if (concurrent) {
+        // Параллельный режим: стратегии стартуют одновременно, каждая со своим ZBar-сканером.
+        // Победитель — стратегия с наивысшим приоритетом среди давших результат, как и при
+        // последовательном проходе. Задачи могут доработать после возврата —
+        // захватываем только контекст кадра и журнал (по значению) и this
+        const auto deadline = options.deadline;
+        auto winner = runPriorityRace<BarcodeResult>(stagePool, kStageCount,
+            [this, frame, log, deadline](int index, const CancellationToken& cancel) {
+                CancellationToken stageCancel(&cancel);
+                stageCancel.setDeadline(deadline);
+                ZBarDecoder zbar;
+                SmartDecoder smart(preprocessor, zbar);
+                return runTrackedStage(static_cast<DecodeStage>(index), *frame, zbar, smart, stageCancel, *log);
+            }, nullptr, false);
+        if (winner) parsedResult = std::move(winner->second);
+    } else {
+        CancellationToken budget;
+        budget.setDeadline(options.deadline);
+        for (auto stage : { DecodeStage::OpenCV, DecodeStage::Curved, DecodeStage::FullFrame }) {
+            if (budget.isTimedOut()) break;
+            parsedResult = runTrackedStage(stage, *frame, zbarDecoder, smartDecoder, budget, *log);
+            if (parsedResult) break;
+        }
+    }
 
-    // 1. ОБЫЧНЫЕ ШТРИХ-КОДЫ (OpenCV)
-    auto polygons = opencvDetector.detectWithOpenCV(frame);
-    std::cout << "OpenCV обнаружено полигонов: " << polygons.size() << std::endl;
+    ScanReport report;
+    report.stages = log->snapshot();
+    if (parsedResult) {
+        report.status = ScanStatus::Decoded;
+        report.result = createDetailedResult(*parsedResult);
+    } else if (ScanOptions::Clock::now() >= options.deadline) {
+        report.status = ScanStatus::TimedOut;
+    }
+    report.elapsedMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - started).count();
+
+    if (report.status == ScanStatus::TimedOut) {
+        std::cout << "=== СКАНИРОВАНИЕ ПРЕРВАНО ПО ВРЕМЕНИ (" << report.elapsedMs << " мс) ===" << std::endl;
+        for (const auto& stage : report.stages) {
+            const char* state = stage.status == StageStatus::NotStarted ? "не начата"
+                              : stage.status == StageStatus::Completed ? "завершена"
+                              : stage.status == StageStatus::TimedOut ? "прервана по времени"
+                              : stage.status == StageStatus::Cancelled ? "отменена" : "выполняется";
+            std::cout << "  " << stage.name << ": " << state << ", " << stage.milliseconds << " мс" << std::endl;
+        }
+    } else if (report.status == ScanStatus::NotFound) {
+        std::cout << "=== СКАНИРОВАНИЕ ЗАВЕРШЕНО, ШТРИХ-КОД НЕ РАСПОЗНАН ===" << std::endl;
+    }
+    return report;
+}
 
-    for (const auto& polygon : polygons) {
-        if (polygon.size() != 4) continue;
+std::optional<BarcodeResult> BarcodeReader::runTrackedStage(DecodeStage stage, const FrameContext& frame, ZBarDecoder& zbar,
+                                                            SmartDecoder& smart, const CancellationToken& cancel,
+                                                            StageLog& log) {
+    log.update(stage, StageStatus::Running);
+    const auto started = std::chrono::steady_clock::now();
+
+    std::optional<BarcodeResult> parsedResult = runStage(stage, frame, zbar, smart, cancel);
+
+    const double milliseconds = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - started).count();
+    const StageStatus status = parsedResult ? StageStatus::Decoded
+                             : cancel.isTimedOut() ? StageStatus::TimedOut
+                             : cancel.isCancelled() ? StageStatus::Cancelled
+                             : StageStatus::Completed;
+    log.update(stage, status, milliseconds);
+    return parsedResult;
+}
 
-        cv::Rect bbox = cv::boundingRect(polygon);
-        cv::Mat roi = frame(bbox);
-        std::string zbarResult = zbarDecoder.decodeWithZBar(roi);
+std::vector<BarcodeResult> BarcodeReader::decodeAll(const cv::Mat& image, const ScanOptions& options) {
+    if (image.empty()) {
+        throw DecodeException("Пустое изображение для декодирования");
+    }
 
-        zbarResult = zbarDecoder.filterBarcodeResult(zbarResult);
+    std::cout << "=== СКАНИРОВАНИЕ ВСЕХ КОДОВ ===" << std::endl;
+    std::cout << "Размер изображения: " << image.cols << "x" << image.rows << std::endl;
 
-        if (!zbarResult.empty()) {
-            BarcodeResult parsedResult = zbarDecoder.parseZBarResult(zbarResult);
-            if (parsedResult.type != "Неизвестно") {
-                std::cout << "УСПЕХ: Распознан через OpenCV + ZBar" << std::endl;
-                return createDetailedResult(parsedResult);
+    const FrameContext frame(image);
+    CancellationToken budget;
+    budget.setDeadline(options.deadline);
+    std::vector<BarcodeResult> found;
+
+    auto addUnique = [&found](BarcodeResult candidate) {
+        const bool duplicate = std::any_of(found.begin(), found.end(),
+                                           [&](const BarcodeResult& known) { return isSameSymbol(known, candidate); });
+        if (!duplicate) found.push_back(std::move(candidate));
+    };
+    auto collect = [&addUnique](std::vector<ZBarSymbol> symbols, cv::Point offset) {
+        for (auto& symbol : symbols) {
+            for (auto& point : symbol.location) {
+                point.x += offset.x;
+                point.y += offset.y;
+            }
+            addUnique(ZBarDecoder::toBarcodeResult(symbol));
+        }
+    };
+
+    // 1. Полигоны OpenCV: прочитанные OpenCV берутся как есть, остальные — через ZBar
+    //    по выпрямленной полосе, а если не вышло — по ограничивающему прямоугольнику
+    if (!budget.isCancelled()) {
+        const cv::Rect frameBounds(cv::Point(0, 0), frame.size());
+        for (const auto& detection : opencvDetector.detectAndDecode(frame.gray())) {
+            if (budget.isCancelled()) break;
+            if (detection.isDecoded()) {
+                addUnique(BarcodeDetectorOpenCV::toBarcodeResult(detection));
+                continue;
             }
+            if (auto strip = BarcodeDetectorOpenCV::rectify(frame.gray(), detection.polygon)) {
+                if (auto parsedResult = zbarDecoder.decodeStrip(strip->image)) {
+                    parsedResult->location = strip->mapToFrame(parsedResult->location);
+                    addUnique(std::move(*parsedResult));
+                    continue;
+                }
+            }
+            const cv::Rect bbox = cv::boundingRect(detection.polygon) & frameBounds;
+            if (bbox.empty()) continue;
+            collect(zbarDecoder.decodeAllWithZBar(frame.grayRoi(bbox)), bbox.tl());
         }
     }
 
-    // 2. СЛОЖНЫЕ ШТРИХ-КОДЫ
-    auto curved_regions = curvedDetector.detectCurvedBarcodesOptimized(frame);
-    std::cout << "Обнаружено изогнутых регионов: " << curved_regions.size() << std::endl;
+    // 2. Изогнутые регионы — все кандидаты, без остановки на первом успехе
+    if (!budget.isCancelled()) {
+        auto regions = curvedDetector.rankRegions(frame, curvedDetector.detectCurvedBarcodesOptimized(frame));
+        for (const auto& region : regions) {
+            if (budget.isCancelled()) break;
+            collect(smartDecoder.decodeAllWithUnwarp(frame.gray(), region.rect, region.angle, &budget), cv::Point(0, 0));
+        }
+    }
 
-    for (const auto& rect : curved_regions) {
-        std::string zbarResult = smartDecoder.smartDecodeWithUnwarp(frame, rect);
+    // 3. Весь кадр
+    if (!budget.isCancelled()) {
+        collect(zbarDecoder.decodeAllWithZBar(frame.gray()), cv::Point(0, 0));
+    }
+
+    enrichResults(found);
+    std::cout << "=== НАЙДЕНО КОДОВ: " << found.size()
+              << (budget.isTimedOut() ? " (прервано по времени) ===" : " ===") << std::endl;
+    return found;
+}
 
-        if (!zbarResult.empty()) {
-            BarcodeResult parsedResult = zbarDecoder.parseZBarResult(zbarResult);
-            if (parsedResult.type != "Неизвестно") {
-                std::cout << "УСПЕХ: Распознан через curved detection" << std::endl;
-                return createDetailedResult(parsedResult);
+std::optional<BarcodeResult> BarcodeReader::runStage(DecodeStage stage, const FrameContext& frame, ZBarDecoder& zbar,
+                                                     SmartDecoder& smart, const CancellationToken& cancel) {
+    switch (stage) {
+    case DecodeStage::OpenCV: {
+        // 1. ОБЫЧНЫЕ ШТРИХ-КОДЫ (OpenCV)
+        if (cancel.isCancelled()) return std::nullopt;
+        auto detections = opencvDetector.detectAndDecode(frame.gray());
+        std::cout << "OpenCV обнаружено полигонов: " << detections.size() << std::endl;
+
+        // Код, уже прочитанный OpenCV, повторно через ZBar не декодируется
+        for (const auto& detection : detections) {
+            if (!detection.isDecoded()) continue;
+            std::cout << "УСПЕХ: Распознан через OpenCV" << std::endl;
+            return BarcodeDetectorOpenCV::toBarcodeResult(detection);
+        }
+
+        // ZBar — только для полигонов, которые OpenCV не прочитал: сначала полоса, выпрямленная
+        // по полигону (несколько строк развёртки без фона), затем ограничивающий прямоугольник
+        for (const auto& detection : detections) {
+            if (cancel.isCancelled()) return std::nullopt;
+            if (detection.polygon.size() != 4) continue;
+
+            if (auto strip = BarcodeDetectorOpenCV::rectify(frame.gray(), detection.polygon)) {
+                if (auto parsedResult = zbar.decodeStrip(strip->image)) {
+                    parsedResult->location = strip->mapToFrame(parsedResult->location);
+                    std::cout << "УСПЕХ: Распознан через OpenCV + выпрямленную полосу" << std::endl;
+                    return parsedResult;
+                }
+            }
+            if (cancel.isCancelled()) return std::nullopt;
+
+            const cv::Rect bbox = cv::boundingRect(detection.polygon) & cv::Rect(cv::Point(0, 0), frame.size());
+            if (bbox.empty()) continue;
+
+            if (auto parsedResult = zbar.decodeBestWithZBar(frame.gray()(bbox))) {
+                for (auto& point : parsedResult->location) {
+                    point.x += bbox.x;
+                    point.y += bbox.y;
+                }
+                std::cout << "УСПЕХ: Распознан через OpenCV + ZBar" << std::endl;
+                return parsedResult;
             }
         }
+        return std::nullopt;
     }
 
-    // 3. ПРЯМОЙ СКАН ВСЕГО ИЗОБРАЖЕНИЯ ZBar
-    std::cout << "Пытаемся прямой ZBar scan всего изображения..." << std::endl;
-    std::string directResult = zbarDecoder.decodeWithZBar(frame);
-    directResult = zbarDecoder.filterBarcodeResult(directResult);
+    case DecodeStage::Curved:
+        // 2. СЛОЖНЫЕ ШТРИХ-КОДЫ
+        return decodeCurvedRegions(frame, smart, cancel);
 
-    if (!directResult.empty()) {
-        BarcodeResult parsedResult = zbarDecoder.parseZBarResult(directResult);
-        if (parsedResult.type != "Неизвестно") {
+    case DecodeStage::FullFrame: {
+        // 3. ПРЯМОЙ СКАН ВСЕГО ИЗОБРАЖЕНИЯ ZBar
+        if (cancel.isCancelled()) return std::nullopt;
+        std::cout << "Пытаемся прямой ZBar scan всего изображения..." << std::endl;
+        if (auto parsedResult = zbar.decodeBestWithZBar(frame.gray())) {
             std::cout << "УСПЕХ: Распознан через прямой ZBar scan" << std::endl;
-            return createDetailedResult(parsedResult);
+            return parsedResult;
+        }
+        return std::nullopt;
+    }
+    }
+    return std::nullopt;
+}
+
+// Изогнутые регионы: кандидаты сортируются по оценке и распознаются параллельно на всех ядрах.
+// Побеждает самый высоко оценённый из распознанных, остальные отменяются между вариантами предобработки
+std::optional<BarcodeResult> BarcodeReader::decodeCurvedRegions(const FrameContext& frame, SmartDecoder& smart,
+                                                                const CancellationToken& cancel) {
+    if (cancel.isCancelled()) return std::nullopt;
+    auto candidates = curvedDetector.detectCurvedBarcodesOptimized(frame);
+    if (cancel.isCancelled()) return std::nullopt;
+    auto curved_regions = curvedDetector.rankRegions(frame, candidates);
+    std::cout << "Обнаружено изогнутых регионов: " << curved_regions.size() << std::endl;
+
+    std::vector<RegionTiming> timings(curved_regions.size());
+    auto decodeRegion = [&](int index, SmartDecoder& regionSmart,
+                            const CancellationToken& regionCancel) -> std::optional<BarcodeResult> {
+        const CurvedRegion& region = curved_regions[index];
+        RegionTiming& timing = timings[index];
+        timing.rect = region.rect;
+        timing.score = region.score;
+
+        const auto started = std::chrono::steady_clock::now();
+        std::optional<BarcodeResult> parsedResult = regionSmart.smartDecodeWithUnwarp(frame.gray(), region.rect, region.angle,
+                                                                                    &regionCancel);
+        timing.milliseconds = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - started).count();
+        timing.cancelled = !parsedResult && regionCancel.isCancelled();
+        timing.decoded = parsedResult.has_value();
+        return parsedResult;
+    };
+
+    std::optional<BarcodeResult> decoded;
+    if (curved_regions.size() > 1 && regionPool.maxThreadCount() > 1) {
+        // Гонка ждёт все задачи: они ссылаются на регионы и замеры этого вызова
+        auto winner = runPriorityRace<BarcodeResult>(regionPool, static_cast<int>(curved_regions.size()),
+            [&](int index, const CancellationToken& regionCancel) {
+                ZBarDecoder regionZBar;
+                SmartDecoder regionSmart(preprocessor, regionZBar);
+                return decodeRegion(index, regionSmart, regionCancel);
+            }, &cancel, true);
+        if (winner) decoded = std::move(winner->second);
+    } else {
+        for (int index = 0; index < static_cast<int>(curved_regions.size()) && !decoded; ++index) {
+            if (cancel.isCancelled()) break;
+            decoded = decodeRegion(index, smart, cancel);
         }
     }
 
-    std::cout << "=== СКАНИРОВАНИЕ ЗАВЕРШЕНО, ШТРИХ-КОД НЕ РАСПОЗНАН ===" << std::endl;
-    throw DecodeException("Штрих-код не распознан");
+    for (const auto& timing : timings) {
+        if (timing.rect.empty()) continue;
+        std::cout << "Регион " << timing.rect << " оценка " << timing.score << ": " << timing.milliseconds << " мс"
+                  << (timing.decoded ? ", распознан" : timing.cancelled ? ", отменён" : "") << std::endl;
+    }
+    {
+        std::lock_guard lock(timingsMutex);
+        regionTimings = std::move(timings);
+    }
+
+    if (decoded) std::cout << "УСПЕХ: Распознан через curved detection" << std::endl;
+    return decoded;
+}
+
+std::vector<RegionTiming> BarcodeReader::lastRegionTimings() const {
+    std::lock_guard lock(timingsMutex);
+    return regionTimings;
 }
 
 std::string BarcodeReader::findProduct(const QString& barcode) {
@@ -114,10 +409,9 @@ std::string BarcodeReader::findProduct(const QString& barcode) {
 
 std::string BarcodeReader::findCountry(std::string_view digits) {
     if (digits.length() < 3) return "Неизвестно";
-    auto country_code = std::string(digits.substr(0, 3));
     try {
-        QString countryName = Country::findCountryByBarcode(QString::fromStdString(country_code));
-        return countryName.isEmpty() ? "Неизвестная страна (" + country_code + ")" : countryName.toStdString();
+        std::string countryName = CountryCatalog::instance().findNameUtf8(digits.substr(0, 3));
+        return countryName.empty() ? "Неизвестная страна" : countryName;
     } catch (const FileException& e) {
         std::cerr << e.what() << std::endl;
         return "Ошибка чтения файла стран";
@@ -126,10 +420,13 @@ std::string BarcodeReader::findCountry(std::string_view digits) {
 
 std::string BarcodeReader::findManufacturer(std::string_view digits) {
     if (digits.length() < 7) return "Н/Д";
-    auto manufacturer_code = std::string(digits.substr(3, 4));
     try {
-        QString manufacturerName = Manufacturer::findManufacturerByCode(QString::fromStdString(manufacturer_code));
-        return manufacturerName.isEmpty() ? "Неизвестный производитель (" + manufacturer_code + ")" : manufacturerName.toStdString();
+        // Префикс компании GS1 переменной длины: ищем самый длинный из каталога
+        auto match = ManufacturerCatalog::instance().find(digits);
+        if (!match.description.isEmpty()) {
+            std::cout << "Найден производитель по префиксу " << digits.substr(0, match.prefixLength) << std::endl;
+        }
+        return manufacturerText(match);
     } catch (const FileException& e) {
         std::cerr << e.what() << std::endl;
         return "Ошибка чтения файла производителей";
@@ -150,7 +447,7 @@ std::string BarcodeReader::findAdditionalProduct(std::string_view digits) {
 
 // Проверка типа EAN-13 или UPC-A
 bool BarcodeReader::isEAN13orUPCA(const BarcodeResult& result) {
-    return (result.type == "EAN-13" || result.type == "UPCA") && result.digits.length() >= 12;
+    return (result.type == "EAN-13" || result.type == "UPCA" || result.type == "UPC-A") && result.digits.length() >= 12;
 }
 
 // Проверка типа EAN-8
@@ -161,24 +458,25 @@ bool BarcodeReader::isEAN8(const BarcodeResult& result) {
 // Нормализация цифр для UPC-A (добавляем ведущий ноль)
 std::string BarcodeReader::normalizeDigits(const BarcodeResult& result) {
     std::string digitsToUse = result.digits;
-    if (result.type == "UPCA" && digitsToUse.length() == 12) {
+    if ((result.type == "UPCA" || result.type == "UPC-A") && digitsToUse.length() == 12) {
         digitsToUse = "0" + digitsToUse;
     }
     return digitsToUse;
 }
 
-// Поиск страны для EAN-8
+// Поиск страны для EAN-8: сначала 3-значный префикс, затем 2-значный
 std::string BarcodeReader::findCountryForEAN8(std::string_view digits) {
     try {
+        auto& countries = CountryCatalog::instance();
         if (digits.length() >= 3) {
-            auto code = std::string(digits.substr(0, 3));
-            QString countryName = Country::findCountryByBarcode(QString::fromStdString(code));
-            if (!countryName.isEmpty()) return countryName.toStdString();
+            if (std::string countryName = countries.findNameUtf8(digits.substr(0, 3)); !countryName.empty()) {
+                return countryName;
+            }
         }
         if (digits.length() >= 2) {
-            auto code = std::string(digits.substr(0, 2));
-            if (QString countryName = Country::findCountryByBarcode(QString::fromStdString(code)); !countryName.isEmpty()) return countryName.toStdString();
-            return "Неизвестная страна (" + code + ")";
+            auto code = digits.substr(0, 2);
+            if (std::string countryName = countries.findNameUtf8(code); !countryName.empty()) return countryName;
+            return "Неизвестная страна (" + std::string(code) + ")";
         }
     } catch (const FileException& e) {
         std::cerr << e.what() << std::endl;
@@ -200,16 +498,144 @@ std::string BarcodeReader::findProductForEAN8(std::string_view digits) {
 }
 
 BarcodeResult BarcodeReader::createDetailedResult(const BarcodeResult& basicResult) {
-    BarcodeResult detailedResult = basicResult;
-    QString fullBarcode = QString::fromStdString(basicResult.digits);
+    auto& cache = EnrichmentCache::instance();
+    if (auto cached = cache.find(basicResult)) {
+        return *cached;
+    }
+    const std::uint64_t generation = cache.generation();
+
+    // --- Поиск товара и производителя ---
+    std::string productText = findProduct(QString::fromStdString(basicResult.digits));
+    std::string manufacturerText = isEAN13orUPCA(basicResult) ? findManufacturer(normalizeDigits(basicResult)) : "";
+    BarcodeResult detailedResult = composeDetailedResult(basicResult, std::move(productText), std::move(manufacturerText));
+
+    cacheDetailedResult(detailedResult, generation);
+    return detailedResult;
+}
 
-    // --- Поиск товара ---
-    detailedResult.productCode = findProduct(fullBarcode);
+// Пакетное обогащение: результаты упорядочиваются по (тип, цифры), повторы схлопываются,
+// товары ищутся по отсортированным ключам и производители — за одно обращение к каждому справочнику
+void BarcodeReader::enrichResults(std::span<BarcodeResult> results) {
+    if (results.empty()) return;
+
+    std::vector<std::size_t> order(results.size());
+    std::iota(order.begin(), order.end(), std::size_t{0});
+    auto sameCode = [&](std::size_t a, std::size_t b) {
+        return results[a].type == results[b].type && results[a].digits == results[b].digits;
+    };
+    std::stable_sort(order.begin(), order.end(), [&](std::size_t a, std::size_t b) {
+        return std::tie(results[a].type, results[a].digits) < std::tie(results[b].type, results[b].digits);
+    });
+
+    // Первый результат каждой группы одинаковых кодов — представитель группы
+    std::vector<std::size_t> unique;
+    std::vector<std::size_t> groupOf(results.size());
+    for (std::size_t i = 0; i < order.size(); ++i) {
+        if (i == 0 || !sameCode(order[i - 1], order[i])) unique.push_back(order[i]);
+        groupOf[order[i]] = unique.size() - 1;
+    }
+
+    // Группы, уже лежащие в кэше, в справочниках не ищем
+    auto& cache = EnrichmentCache::instance();
+    const std::uint64_t generation = cache.generation();
+    std::vector<std::optional<BarcodeResult>> cached(unique.size());
+    for (std::size_t u = 0; u < unique.size(); ++u) {
+        cached[u] = cache.find(results[unique[u]]);
+    }
+
+    // --- Товары: ключи по возрастанию, один проход по каталогу ---
+    std::vector<std::pair<std::uint64_t, std::size_t>> productKeys;
+    productKeys.reserve(unique.size());
+    for (std::size_t u = 0; u < unique.size(); ++u) {
+        if (cached[u]) continue;
+        if (auto key = ProductCatalog::productKey(std::string_view(results[unique[u]].digits))) {
+            productKeys.emplace_back(*key, u);
+        }
+    }
+    std::sort(productKeys.begin(), productKeys.end());
+
+    std::vector<std::uint64_t> sortedKeys(productKeys.size());
+    std::transform(productKeys.begin(), productKeys.end(), sortedKeys.begin(), [](const auto& entry) { return entry.first; });
+    std::vector<QString> productDescriptions(productKeys.size());
+
+    std::vector<std::string> productTexts(unique.size());
+    try {
+        ProductCatalog::instance().find(sortedKeys, productDescriptions);
+        std::vector<QString> byUnique(unique.size());
+        for (std::size_t k = 0; k < productKeys.size(); ++k) {
+            byUnique[productKeys[k].second] = std::move(productDescriptions[k]);
+        }
+        for (std::size_t u = 0; u < unique.size(); ++u) {
+            if (!cached[u]) productTexts[u] = productText(byUnique[u], results[unique[u]].digits);
+        }
+    } catch (const FileException& e) {
+        std::cerr << e.what() << std::endl;
+        std::fill(productTexts.begin(), productTexts.end(), "Ошибка чтения файла товаров");
+    }
+
+    // --- Производители: только для EAN-13/UPC-A ---
+    std::vector<std::string> normalized(unique.size());
+    std::vector<std::string> manufacturerTexts(unique.size());
+    std::vector<std::string_view> manufacturerQueries;
+    std::vector<std::size_t> manufacturerOwners;
+    for (std::size_t u = 0; u < unique.size(); ++u) {
+        const BarcodeResult& result = results[unique[u]];
+        if (cached[u] || !isEAN13orUPCA(result)) continue;
+        normalized[u] = normalizeDigits(result);
+        if (normalized[u].length() < 7) {
+            manufacturerTexts[u] = "Н/Д";
+            continue;
+        }
+        manufacturerQueries.push_back(normalized[u]);
+        manufacturerOwners.push_back(u);
+    }
+
+    std::vector<ManufacturerCatalog::Match> matches(manufacturerQueries.size());
+    try {
+        ManufacturerCatalog::instance().find(manufacturerQueries, matches);
+        for (std::size_t m = 0; m < matches.size(); ++m) {
+            manufacturerTexts[manufacturerOwners[m]] = manufacturerText(matches[m]);
+        }
+    } catch (const FileException& e) {
+        std::cerr << e.what() << std::endl;
+        for (std::size_t owner : manufacturerOwners) manufacturerTexts[owner] = "Ошибка чтения файла производителей";
+    }
+
+    // --- Сборка: один раз на группу, копии — остальным ---
+    std::vector<BarcodeResult> detailed;
+    detailed.reserve(unique.size());
+    std::size_t cacheHits = 0;
+    for (std::size_t u = 0; u < unique.size(); ++u) {
+        if (cached[u]) {
+            detailed.push_back(std::move(*cached[u]));
+            ++cacheHits;
+            continue;
+        }
+        detailed.push_back(composeDetailedResult(results[unique[u]], std::move(productTexts[u]),
+                                                 std::move(manufacturerTexts[u])));
+        cacheDetailedResult(detailed.back(), generation);
+    }
+    for (std::size_t i = 0; i < results.size(); ++i) {
+        const BarcodeResult& source = detailed[groupOf[i]];
+        results[i].country = source.country;
+        results[i].manufacturerCode = source.manufacturerCode;
+        results[i].productCode = source.productCode;
+    }
+
+    std::cout << "Пакетное обогащение: " << results.size() << " результатов, "
+              << unique.size() << " уникальных кодов, из кэша " << cacheHits << std::endl;
+}
+
+// Заполнение страны, производителя и товара по типу кода; товар и производитель уже найдены
+BarcodeResult BarcodeReader::composeDetailedResult(const BarcodeResult& basicResult, std::string productText,
+                                                   std::string manufacturerText) {
+    BarcodeResult detailedResult = basicResult;
+    detailedResult.productCode = std::move(productText);
 
     if (isEAN13orUPCA(basicResult)) {
         std::string digitsToUse = normalizeDigits(basicResult);
         detailedResult.country = findCountry(digitsToUse);
-        detailedResult.manufacturerCode = findManufacturer(digitsToUse);
+        detailedResult.manufacturerCode = std::move(manufacturerText);
 
         if (detailedResult.productCode == "Н/Д") {
             detailedResult.productCode = findAdditionalProduct(digitsToUse);
@@ -1,12 +1,18 @@
 #include "CameraManager.h"
 #include <QDebug>
+#include <chrono>
 #include "CameraException.h"
 
+namespace {
+
+// Пауза после неудачного чтения, чтобы отключённая камера не загружала ядро
+constexpr auto kReadRetryDelay = std::chrono::milliseconds(5);
+
+} // namespace
+
 CameraManager::CameraManager(QObject* parent)
     : QObject(parent)
 {
-    frameTimer = new QTimer(this);
-    connect(frameTimer, &QTimer::timeout, this, &CameraManager::updateFrame);
 }
 
 
@@ -22,7 +28,9 @@ bool CameraManager::startCamera(int cameraIndex) {
         tryOpenCameraWithBackend(cameraIndex, cv::CAP_MSMF) ||
         tryOpenCameraWithBackend(cameraIndex, cv::CAP_ANY)) {
         cameraActive = true;
-        frameTimer->start(33);
+        // Кадры читаются в своём потоке: блокирующее чтение камеры не держит цикл событий
+        capturing = true;
+        captureThread = std::thread(&CameraManager::captureLoop, this);
         emit cameraStarted();
         return true;
     }
@@ -54,9 +62,12 @@ bool CameraManager::tryOpenCameraWithBackend(int cameraIndex, int backend)
 
 void CameraManager::stopCamera()
 {
-    if (frameTimer->isActive()) {
-        frameTimer->stop();
+    capturing = false;
+    if (captureThread.joinable()) {
+        captureThread.join();
     }
+    frames.reset();
+    notifyPending = false;
 
     if (videoCapture) {
         if (videoCapture->isOpened()) {
@@ -77,9 +88,22 @@ bool CameraManager::isCameraActive() const
     return cameraActive;
 }
 
+FrameRing::FrameRef CameraManager::latestFrame() const
+{
+    // Взятый кадр разрешает следующий сигнал frameReady
+    notifyPending = false;
+    return frames.latest();
+}
+
+FrameRing::FrameRef CameraManager::peekFrame() const
+{
+    return frames.latest();
+}
+
 cv::Mat CameraManager::getCurrentFrame() const
 {
-    return currentFrame.clone();
+    FrameRing::FrameRef frame = peekFrame();
+    return frame ? frame.image().clone() : cv::Mat();
 }
 
 void CameraManager::setMirrorMode(bool enabled)
@@ -87,19 +111,53 @@ void CameraManager::setMirrorMode(bool enabled)
     mirrorMode = enabled;
 }
 
-void CameraManager::updateFrame()
+CameraManager::CaptureStats CameraManager::captureStats() const
 {
-    if (videoCapture && videoCapture->isOpened()) {
-        cv::Mat frame;
-        *videoCapture >> frame;
+    CaptureStats stats;
+    stats.captured = frames.published();
+    stats.dropped = frames.dropped();
+    stats.lastLatencyMs = lastLatencyMicros.load(std::memory_order_relaxed) / 1000.0;
+    stats.averageLatencyMs = averageLatencyMicros.load(std::memory_order_relaxed) / 1000.0;
+    return stats;
+}
+
+void CameraManager::captureLoop()
+{
+    // Кадр, для которого не нашлось слота, всё равно вычитывается, чтобы камера не копила очередь
+    cv::Mat discarded;
+
+    while (capturing) {
+        cv::Mat* target = frames.beginWrite();
+        cv::Mat& frame = target ? *target : discarded;
 
-        if (!frame.empty()) {
-            if (mirrorMode) {
-                cv::flip(frame, frame, 1); // Горизонтальное отражение
-            }
+        const auto started = FrameRing::Clock::now();
+        const bool read = videoCapture->read(frame);
+        const auto captured = FrameRing::Clock::now();
+
+        if (!read || frame.empty()) {
+            std::this_thread::sleep_for(kReadRetryDelay);
+            continue;
+        }
+        const auto latency = static_cast<std::uint64_t>(
+            std::chrono::duration_cast<std::chrono::microseconds>(captured - started).count());
+        lastLatencyMicros.store(latency, std::memory_order_relaxed);
+        // Скользящее среднее с весом 1/16
+        const std::uint64_t average = averageLatencyMicros.load(std::memory_order_relaxed);
+        averageLatencyMicros.store(average == 0 ? latency : average - average / 16 + latency / 16,
+                                   std::memory_order_relaxed);
+
+        if (!target) {
+            frames.dropFrame();
+            continue;
+        }
+        if (mirrorMode) {
+            cv::flip(frame, frame, 1); // Горизонтальное отражение, на месте в слоте
+        }
+        frames.publish(captured);
 
-            currentFrame = frame.clone();
-            emit frameReady(frame);
+        emit frameCaptured();
+        if (!notifyPending.exchange(true)) {
+            emit frameReady();
         }
     }
 }
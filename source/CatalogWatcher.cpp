@@ -0,0 +1,136 @@
+#include "CatalogWatcher.h"
+#include <QDir>
+#include <QFileInfo>
+#include <QFileSystemWatcher>
+#include <QTimer>
+#include <iostream>
+#include "BarcodeException.h"
+#include "CompiledCatalog.h"
+#include "CountryCatalog.h"
+#include "EnrichmentCache.h"
+#include "ManufacturerCatalog.h"
+#include "ProductCatalog.h"
+
+namespace {
+
+const QString kProductsFile = QStringLiteral("Barcode_Products.txt");
+const QString kCountriesFile = QStringLiteral("Barcode_Countries.txt");
+const QString kManufacturersFile = QStringLiteral("Barcode_Manufacturers.txt");
+const QString kCompiledFile = QStringLiteral("Barcode_Catalog.bin");
+
+const QStringList kWatchedFiles = { kProductsFile, kCountriesFile, kManufacturersFile, kCompiledFile };
+
+constexpr int kDebounceMs = 300;   // редакторы и QSaveFile пишут файл в несколько приёмов
+
+} // namespace
+
+CatalogWatcher::CatalogWatcher(const QString& dataDir, QObject* parent)
+    : QObject(parent),
+    dataDir(dataDir),
+    watcher(new QFileSystemWatcher(this)),
+    debounceTimer(new QTimer(this))
+{
+    reloadPool.setMaxThreadCount(1);
+    clock.start();
+
+    debounceTimer->setSingleShot(true);
+    debounceTimer->setInterval(kDebounceMs);
+    connect(debounceTimer, &QTimer::timeout, this, &CatalogWatcher::checkForChanges);
+
+    // Каталог тоже отслеживаем: атомарная запись подменяет файл, и наблюдение за ним теряется
+    connect(watcher, &QFileSystemWatcher::fileChanged, this, &CatalogWatcher::onPathChanged);
+    connect(watcher, &QFileSystemWatcher::directoryChanged, this, &CatalogWatcher::onPathChanged);
+
+    watcher->addPath(dataDir);
+    watchExistingFiles();
+    for (const QString& fileName : kWatchedFiles) {
+        knownStamps.insert(fileName, stampOf(fileName));
+    }
+}
+
+CatalogWatcher::~CatalogWatcher()
+{
+    // Фоновая перезагрузка испускает сигналы этого объекта — дожидаемся её до разрушения
+    reloadPool.waitForDone();
+}
+
+void CatalogWatcher::onPathChanged()
+{
+    if (firstChangeAt < 0) {
+        firstChangeAt = clock.elapsed();
+    }
+    debounceTimer->start();
+}
+
+void CatalogWatcher::checkForChanges()
+{
+    watchExistingFiles();
+
+    for (const QString& fileName : kWatchedFiles) {
+        const FileStamp stamp = stampOf(fileName);
+        if (stamp == knownStamps.value(fileName)) continue;
+
+        knownStamps.insert(fileName, stamp);
+        reloadInBackground(fileName, firstChangeAt);
+    }
+    firstChangeAt = -1;
+}
+
+void CatalogWatcher::watchExistingFiles()
+{
+    const QStringList watchedFiles = watcher->files();
+    for (const QString& fileName : kWatchedFiles) {
+        const QString path = QDir(dataDir).filePath(fileName);
+        if (QFileInfo::exists(path) && !watchedFiles.contains(path)) {
+            watcher->addPath(path);
+        }
+    }
+}
+
+CatalogWatcher::FileStamp CatalogWatcher::stampOf(const QString& fileName) const
+{
+    const QFileInfo info(QDir(dataDir).filePath(fileName));
+    if (!info.exists()) return {};
+    return { info.lastModified(), info.size() };
+}
+
+void CatalogWatcher::reloadInBackground(const QString& fileName, qint64 detectedAt)
+{
+    reloadPool.start([this, fileName, detectedAt] {
+        QElapsedTimer buildTimer;
+        buildTimer.start();
+
+        try {
+            if (fileName == kCompiledFile) {
+                // Новый бинарный каталог подменяет и индексы, построенные поверх него
+                CompiledCatalog::reloadDefault();
+                ProductCatalog::instance().reload();
+                CountryCatalog::instance().reload();
+                ManufacturerCatalog::instance().reload();
+            } else if (fileName == kProductsFile) {
+                ProductCatalog::instance().reload();
+            } else if (fileName == kCountriesFile) {
+                CountryCatalog::instance().reload();
+            } else if (fileName == kManufacturersFile) {
+                ManufacturerCatalog::instance().reload();
+            }
+        }
+        catch (const BarcodeException& e) {
+            std::cerr << "Не удалось перезагрузить " << fileName.toStdString() << ": " << e.what() << std::endl;
+            emit catalogReloadFailed(fileName, QString::fromUtf8(e.what()));
+            return;
+        }
+
+        // Кэш обогащённых результатов собран по старым справочникам
+        const EnrichmentCache::Stats cacheStats = EnrichmentCache::instance().stats();
+        EnrichmentCache::instance().invalidate();
+        std::cout << "Кэш результатов сброшен: попаданий " << cacheStats.hits
+                  << ", промахов " << cacheStats.misses << ", записей " << cacheStats.size << std::endl;
+
+        const qint64 buildMs = buildTimer.elapsed();
+        const qint64 latencyMs = clock.elapsed() - detectedAt;
+        std::cout << "Справочник перезагружен: " << fileName.toStdString()
+                  << " (построение " << buildMs << " мс, задержка " << latencyMs << " мс)" << std::endl;
+        emit catalogReloaded(fileName, buildMs, latencyMs);
+    });
+}
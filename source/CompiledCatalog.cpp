@@ -0,0 +1,377 @@
+#include "CompiledCatalog.h"
+#include <QByteArray>
+#include <QSaveFile>
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <iostream>
+#include <limits>
+#include <string>
+#include <vector>
+#include "CatalogText.h"
+#include "FileException.h"
+#include "ProductCatalog.h"
+#include "SnapshotSlot.h"
+
+namespace {
+
+constexpr char kMagic[8] = {'B', 'C', 'A', 'T', 'A', 'L', 'O', 'G'};
+
+static_assert(sizeof(CompiledCatalog::Header) % 8 == 0, "секции после заголовка должны быть выровнены по 8 байт");
+
+std::uint64_t fnv1a64(const uchar* bytes, std::size_t size)
+{
+    std::uint64_t hash = 14695981039346656037ull;
+    for (std::size_t i = 0; i < size; ++i) {
+        hash ^= bytes[i];
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
+
+std::uint64_t headerChecksum(const CompiledCatalog::Header& header)
+{
+    return fnv1a64(reinterpret_cast<const uchar*>(&header), offsetof(CompiledCatalog::Header, headerChecksum));
+}
+
+// Секция [offset, offset + count * elementSize) целиком внутри файла и выровнена
+bool sectionFits(std::uint64_t offset, std::uint64_t count, std::uint64_t elementSize,
+                 std::uint64_t alignment, std::uint64_t fileSize)
+{
+    return offset % alignment == 0 && offset <= fileSize && count <= (fileSize - offset) / elementSize;
+}
+
+QByteArray readTextFile(const QString& filePath)
+{
+    QFile file(filePath);
+    if (!file.open(QIODevice::ReadOnly)) {
+        throw FileException("Не удалось открыть файл каталога: " + filePath.toStdString());
+    }
+    return file.readAll();
+}
+
+std::string_view asView(const QByteArray& bytes)
+{
+    return std::string_view(bytes.constData(), static_cast<std::size_t>(bytes.size()));
+}
+
+struct KeyedString
+{
+    std::uint64_t key;
+    std::uint32_t offset;
+};
+
+// Сортировка по ключу; из повторов остаётся первая строка файла — как при линейном поиске
+void sortUnique(std::vector<KeyedString>& entries)
+{
+    std::stable_sort(entries.begin(), entries.end(),
+                     [](const KeyedString& a, const KeyedString& b) { return a.key < b.key; });
+    entries.erase(std::unique(entries.begin(), entries.end(),
+                              [](const KeyedString& a, const KeyedString& b) { return a.key == b.key; }),
+                  entries.end());
+}
+
+// Текущий каталог по умолчанию; сам shared_ptr подменяется через SnapshotSlot без блокировок читателей
+struct DefaultCatalogRef
+{
+    std::shared_ptr<const CompiledCatalog> catalog;
+};
+
+SnapshotSlot<DefaultCatalogRef>& defaultCatalogSlot()
+{
+    static SnapshotSlot<DefaultCatalogRef> slot;
+    return slot;
+}
+
+std::unique_ptr<const DefaultCatalogRef> openDefaultCatalog()
+{
+    auto opened = std::make_shared<CompiledCatalog>();
+    auto ref = std::make_unique<DefaultCatalogRef>();
+    if (opened->open("C:/Users/rauko/Desktop/BarcodeScanner/data/Barcode_Catalog.bin")) {
+        ref->catalog = std::move(opened);
+    }
+    return ref;
+}
+
+} // namespace
+
+CompiledCatalog::~CompiledCatalog()
+{
+    close();
+}
+
+bool CompiledCatalog::open(const QString& filePath, bool verifyPayload)
+{
+    close();
+
+    auto mappedFile = std::make_unique<QFile>(filePath);
+    if (!mappedFile->exists() || !mappedFile->open(QIODevice::ReadOnly)) {
+        return false;
+    }
+
+    const qint64 size = mappedFile->size();
+    if (size < static_cast<qint64>(sizeof(Header))) {
+        std::cerr << "Скомпилированный каталог слишком мал: " << filePath.toStdString() << std::endl;
+        return false;
+    }
+
+    const uchar* bytes = mappedFile->map(0, size);
+    if (!bytes) {
+        std::cerr << "Не удалось отобразить каталог в память: " << filePath.toStdString() << std::endl;
+        return false;
+    }
+
+    const auto* mappedHeader = reinterpret_cast<const Header*>(bytes);
+    const auto fileSize = static_cast<std::uint64_t>(size);
+    const char* problem = nullptr;
+
+    if (std::memcmp(mappedHeader->magic, kMagic, sizeof(kMagic)) != 0) {
+        problem = "неизвестный формат";
+    } else if (mappedHeader->version != kFormatVersion || mappedHeader->headerSize != sizeof(Header)) {
+        problem = "неподдерживаемая версия формата";
+    } else if (mappedHeader->fileSize != fileSize || mappedHeader->headerChecksum != headerChecksum(*mappedHeader)) {
+        problem = "повреждён заголовок";
+    } else if (!sectionFits(mappedHeader->productKeysOffset, mappedHeader->productCount, 8, 8, fileSize)
+               || !sectionFits(mappedHeader->productStringsOffset, mappedHeader->productCount, 4, 4, fileSize)
+               || !sectionFits(mappedHeader->manufacturerKeysOffset, mappedHeader->manufacturerCount, 8, 8, fileSize)
+               || !sectionFits(mappedHeader->manufacturerStringsOffset, mappedHeader->manufacturerCount, 4, 4, fileSize)
+               || !sectionFits(mappedHeader->countryStringsOffset, mappedHeader->countryCount, 4, 4, fileSize)
+               || !sectionFits(mappedHeader->countryPrefix3Offset, 1000, 2, 2, fileSize)
+               || !sectionFits(mappedHeader->countryPrefix2Offset, 100, 2, 2, fileSize)
+               || !sectionFits(mappedHeader->stringPoolOffset, mappedHeader->stringPoolSize, 1, 1, fileSize)) {
+        problem = "секции выходят за границы файла";
+    } else if (verifyPayload
+               && fnv1a64(bytes + sizeof(Header), fileSize - sizeof(Header)) != mappedHeader->payloadChecksum) {
+        problem = "не совпала контрольная сумма";
+    }
+
+    if (problem) {
+        std::cerr << "Скомпилированный каталог отклонён (" << problem << "): " << filePath.toStdString() << std::endl;
+        mappedFile->unmap(const_cast<uchar*>(bytes));
+        return false;
+    }
+
+    file = std::move(mappedFile);
+    data = bytes;
+    header = mappedHeader;
+
+    std::cout << "Скомпилированный каталог подключён: " << header->productCount << " товаров, "
+              << header->manufacturerCount << " производителей" << std::endl;
+    return true;
+}
+
+void CompiledCatalog::close()
+{
+    if (file && data) {
+        file->unmap(const_cast<uchar*>(data));
+    }
+    file.reset();
+    data = nullptr;
+    header = nullptr;
+}
+
+QString CompiledCatalog::findProduct(std::uint64_t key) const
+{
+    if (!header) return QString();
+    return findString(header->productKeysOffset, header->productStringsOffset, header->productCount, key);
+}
+
+QString CompiledCatalog::findManufacturer(std::uint64_t key) const
+{
+    if (!header) return QString();
+    return findString(header->manufacturerKeysOffset, header->manufacturerStringsOffset,
+                      header->manufacturerCount, key);
+}
+
+std::uint64_t CompiledCatalog::productKey(std::size_t position) const
+{
+    if (!header || position >= header->productCount) return 0;
+    return reinterpret_cast<const std::uint64_t*>(data + header->productKeysOffset)[position];
+}
+
+std::uint64_t CompiledCatalog::manufacturerKey(std::size_t position) const
+{
+    if (!header || position >= header->manufacturerCount) return 0;
+    return reinterpret_cast<const std::uint64_t*>(data + header->manufacturerKeysOffset)[position];
+}
+
+QString CompiledCatalog::manufacturerAt(std::size_t position) const
+{
+    if (!header || position >= header->manufacturerCount) return QString();
+    const auto* stringOffsets = reinterpret_cast<const std::uint32_t*>(data + header->manufacturerStringsOffset);
+    return qStringFromUtf8(stringAt(stringOffsets[position]));
+}
+
+void CompiledCatalog::findProducts(std::span<const std::uint64_t> sortedKeys, std::span<QString> descriptions) const
+{
+    if (!header) return;
+
+    const auto* keys = reinterpret_cast<const std::uint64_t*>(data + header->productKeysOffset);
+    const auto* keysEnd = keys + header->productCount;
+    const auto* stringOffsets = reinterpret_cast<const std::uint32_t*>(data + header->productStringsOffset);
+
+    // Следующий ключ не меньше предыдущего — поиск продолжается с места прошлой находки
+    const std::uint64_t* cursor = keys;
+    for (std::size_t i = 0; i < sortedKeys.size() && i < descriptions.size(); ++i) {
+        cursor = std::lower_bound(cursor, keysEnd, sortedKeys[i]);
+        if (cursor == keysEnd) break;
+        if (*cursor == sortedKeys[i]) {
+            descriptions[i] = qStringFromUtf8(stringAt(stringOffsets[cursor - keys]));
+        }
+    }
+}
+
+CountryPrefixTable CompiledCatalog::countryTable() const
+{
+    CountryPrefixTable table;
+    if (!header) return table;
+
+    std::memcpy(table.byPrefix3.data(), data + header->countryPrefix3Offset, sizeof(table.byPrefix3));
+    std::memcpy(table.byPrefix2.data(), data + header->countryPrefix2Offset, sizeof(table.byPrefix2));
+
+    const auto* nameOffsets = reinterpret_cast<const std::uint32_t*>(data + header->countryStringsOffset);
+    table.names.reserve(header->countryCount);
+    for (std::uint64_t i = 0; i < header->countryCount; ++i) {
+        table.names.emplace_back(stringAt(nameOffsets[i]));
+    }
+    return table;
+}
+
+QString CompiledCatalog::findString(std::uint64_t keysOffset, std::uint64_t stringsOffset, std::uint64_t count,
+                                    std::uint64_t key) const
+{
+    const auto* keys = reinterpret_cast<const std::uint64_t*>(data + keysOffset);
+    const auto* found = std::lower_bound(keys, keys + count, key);
+    if (found == keys + count || *found != key) return QString();
+
+    const auto* stringOffsets = reinterpret_cast<const std::uint32_t*>(data + stringsOffset);
+    return qStringFromUtf8(stringAt(stringOffsets[found - keys]));
+}
+
+std::string_view CompiledCatalog::stringAt(std::uint32_t poolOffset) const
+{
+    const std::uint64_t poolSize = header->stringPoolSize;
+    if (std::uint64_t(poolOffset) + sizeof(std::uint32_t) > poolSize) return {};
+
+    const uchar* entry = data + header->stringPoolOffset + poolOffset;
+    std::uint32_t length = 0;
+    std::memcpy(&length, entry, sizeof(length));
+    if (std::uint64_t(poolOffset) + sizeof(length) + length > poolSize) return {};
+
+    return std::string_view(reinterpret_cast<const char*>(entry + sizeof(length)), length);
+}
+
+std::shared_ptr<const CompiledCatalog> CompiledCatalog::defaultCatalog()
+{
+    auto current = defaultCatalogSlot().readOrCreate(&openDefaultCatalog);
+    return current->catalog;
+}
+
+void CompiledCatalog::reloadDefault()
+{
+    defaultCatalogSlot().publish(openDefaultCatalog());
+}
+
+CompiledCatalog::BuildStats CompiledCatalog::compile(const QString& productsPath, const QString& manufacturersPath,
+                                                     const QString& countriesPath, const QString& outputPath)
+{
+    const QByteArray productsText = readTextFile(productsPath);
+    const QByteArray manufacturersText = readTextFile(manufacturersPath);
+    const QByteArray countriesText = readTextFile(countriesPath);
+
+    std::string pool;
+    auto addString = [&pool](std::string_view text) {
+        if (pool.size() + sizeof(std::uint32_t) + text.size() > std::numeric_limits<std::uint32_t>::max()) {
+            throw FileException("Пул строк каталога превышает 4 ГБ");
+        }
+        const auto offset = static_cast<std::uint32_t>(pool.size());
+        const auto length = static_cast<std::uint32_t>(text.size());
+        pool.append(reinterpret_cast<const char*>(&length), sizeof(length));
+        pool.append(text);
+        return offset;
+    };
+
+    std::vector<KeyedString> products;
+    forEachProductRecord(asView(productsText), [&](std::string_view barcode, std::string_view manufacturer,
+                                                   std::string_view name) {
+        if (auto key = ProductCatalog::productKey(barcode)) {
+            products.push_back({*key, addString(productDescription(barcode, manufacturer, name))});
+        }
+    });
+    sortUnique(products);
+
+    std::vector<KeyedString> manufacturers;
+    forEachManufacturerRecord(asView(manufacturersText), [&](std::string_view code, std::string_view name,
+                                                             std::string_view country) {
+        if (auto key = ProductCatalog::packGtin(code)) {
+            manufacturers.push_back({*key, addString(manufacturerDescription(code, name, country))});
+        }
+    });
+    sortUnique(manufacturers);
+
+    const CountryPrefixTable countries = CountryPrefixTable::parse(asView(countriesText));
+    std::vector<std::uint32_t> countryOffsets;
+    countryOffsets.reserve(countries.names.size());
+    for (const auto& name : countries.names) {
+        countryOffsets.push_back(addString(name));
+    }
+
+    // Полезная нагрузка собирается целиком, чтобы посчитать контрольную сумму до записи заголовка
+    std::string payload;
+    auto currentOffset = [&payload] { return sizeof(Header) + payload.size(); };
+    auto appendAligned = [&payload, &currentOffset](const void* bytes, std::size_t size) {
+        payload.resize((payload.size() + 7) & ~std::size_t(7), '\0');
+        const std::uint64_t offset = currentOffset();
+        payload.append(static_cast<const char*>(bytes), size);
+        return offset;
+    };
+
+    std::vector<std::uint64_t> keys;
+    std::vector<std::uint32_t> offsets;
+    auto appendKeyed = [&](const std::vector<KeyedString>& entries, std::uint64_t& keysOffset,
+                           std::uint64_t& stringsOffset) {
+        keys.clear();
+        offsets.clear();
+        for (const auto& entry : entries) {
+            keys.push_back(entry.key);
+            offsets.push_back(entry.offset);
+        }
+        keysOffset = appendAligned(keys.data(), keys.size() * sizeof(std::uint64_t));
+        stringsOffset = appendAligned(offsets.data(), offsets.size() * sizeof(std::uint32_t));
+    };
+
+    Header header{};
+    std::memcpy(header.magic, kMagic, sizeof(kMagic));
+    header.version = kFormatVersion;
+    header.headerSize = sizeof(Header);
+    header.productCount = products.size();
+    header.manufacturerCount = manufacturers.size();
+    header.countryCount = countries.names.size();
+
+    appendKeyed(products, header.productKeysOffset, header.productStringsOffset);
+    appendKeyed(manufacturers, header.manufacturerKeysOffset, header.manufacturerStringsOffset);
+    header.countryStringsOffset = appendAligned(countryOffsets.data(), countryOffsets.size() * sizeof(std::uint32_t));
+    header.countryPrefix3Offset = appendAligned(countries.byPrefix3.data(), sizeof(countries.byPrefix3));
+    header.countryPrefix2Offset = appendAligned(countries.byPrefix2.data(), sizeof(countries.byPrefix2));
+    header.stringPoolOffset = appendAligned(pool.data(), pool.size());
+    header.stringPoolSize = pool.size();
+    header.fileSize = currentOffset();
+    header.payloadChecksum = fnv1a64(reinterpret_cast<const uchar*>(payload.data()), payload.size());
+    header.headerChecksum = headerChecksum(header);
+
+    // QSaveFile подменяет файл атомарно: читатели видят либо старый, либо новый каталог целиком
+    QSaveFile output(outputPath);
+    if (!output.open(QIODevice::WriteOnly)
+        || output.write(reinterpret_cast<const char*>(&header), sizeof(header)) != qint64(sizeof(header))
+        || output.write(payload.data(), qint64(payload.size())) != qint64(payload.size())
+        || !output.commit()) {
+        throw FileException("Не удалось записать скомпилированный каталог: " + outputPath.toStdString());
+    }
+
+    BuildStats stats;
+    stats.products = products.size();
+    stats.manufacturers = manufacturers.size();
+    stats.countries = countries.names.size();
+    stats.fileSize = static_cast<qint64>(header.fileSize);
+    return stats;
+}
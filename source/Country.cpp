@@ -1,10 +1,5 @@
 ﻿#include "Country.h"
-#include <QFile>
-#include <QTextStream>
-#include <QDebug>
-#include <QRegularExpression>
-
-#include "FileException.h"
+#include "CountryCatalog.h"
 Country::Country(const QString& code, const QString& name)
     : countryCode(code), countryName(name) {}
 
@@ -13,59 +8,15 @@ QString Country::getCountryName() const { return countryName; }
 QString Country::getFullInfo() const { return countryName + " (" + countryCode + ")"; }
 bool Country::isValid() const { return !countryCode.isEmpty() && !countryName.isEmpty(); }
 
-// 📂 Поиск страны по первым 2–3 цифрам штрих-кода
-// 📂 Поиск страны по первым 2–3 цифрам штрих-кода
+// 📂 Поиск страны по первым 2–3 цифрам штрих-кода (одно чтение из таблицы префиксов)
 QString Country::findCountryByBarcode(const QString& barcode)
 {
     if (barcode.isEmpty()) return QString();
+    if (CountryCatalog::digitCount(barcode) < 2) return QString();
 
-    QString digits = barcode;
-    digits.remove(QRegularExpression("[^0-9]"));
-    if (digits.length() < 2) return QString();
-
-    QString prefix3 = digits.left(3);
-    QString prefix2 = digits.left(2);
-    int pref3 = prefix3.toInt();
-    int pref2 = prefix2.toInt();
-
-    QString filePath = "C:/Users/rauko/Desktop/BarcodeScanner/data/Barcode_Countries.txt";
-    QFile file(filePath);
-    if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
-        throw FileException("Не удалось открыть файл стран: " + filePath.toStdString());
-    }
-
-    QTextStream in(&file);
-    while (!in.atEnd()) {
-        QString line = in.readLine().trimmed();
-        if (line.isEmpty() || line.startsWith("#")) continue;
-
-        int colonPos = line.indexOf(':');
-        if (colonPos == -1) continue;
-
-        QString codes = line.left(colonPos).trimmed();
-        QString countryName = line.mid(colonPos + 1).trimmed();
-
-        if (codes.contains('-')) {
-            QStringList parts = codes.split('-');
-            if (parts.size() != 2) continue;
-
-            int start = parts[0].toInt();
-            int end   = parts[1].toInt();
-
-            // Упрощенное условие без глубокой вложенности
-            bool isInRange = (pref3 >= start && pref3 <= end) || (pref2 >= start && pref2 <= end);
-            if (isInRange) {
-                file.close();
-                return countryName;
-            }
-        } else {
-            if (codes == prefix3 || codes == prefix2) {
-                file.close();
-                return countryName;
-            }
-        }
+    if (QString countryName = CountryCatalog::instance().findName(barcode); !countryName.isEmpty()) {
+        return countryName;
     }
 
-    file.close();
     return QString("Неизвестная страна");
 }
@@ -0,0 +1,189 @@
+#include "CountryCatalog.h"
+#include <QFile>
+#include <QByteArray>
+#include <algorithm>
+#include <charconv>
+#include <iostream>
+#include <optional>
+#include <unordered_map>
+#include "CatalogText.h"
+#include "CompiledCatalog.h"
+#include "FileException.h"
+
+namespace {
+
+// Первые (не более 3) цифры строки; прочие символы пропускаются, как раньше делал regex "[^0-9]"
+struct DigitPrefix {
+    int value = 0;
+    int count = 0;
+};
+
+template <typename Text>
+DigitPrefix digitPrefix(const Text& barcode)
+{
+    DigitPrefix prefix;
+    for (auto ch : barcode) {
+        const char16_t code = catalogCharCode(ch);
+        if (!isAsciiDigit(code)) continue;
+        prefix.value = prefix.value * 10 + (code - u'0');
+        if (++prefix.count == 3) break;
+    }
+    return prefix;
+}
+
+std::optional<int> parseNumber(std::string_view text)
+{
+    text = trimmedView(text);
+    int value = 0;
+    auto [ptr, ec] = std::from_chars(text.data(), text.data() + text.size(), value);
+    if (ec != std::errc() || ptr != text.data() + text.size()) return std::nullopt;
+    return value;
+}
+
+} // namespace
+
+CountryCatalog& CountryCatalog::instance()
+{
+    static CountryCatalog catalog;
+    return catalog;
+}
+
+template <typename Text>
+std::uint16_t CountryCatalog::lookup(const Index& index, const Text& barcode)
+{
+    const DigitPrefix prefix = digitPrefix(barcode);
+    if (prefix.count < 2) return kNoCountry;
+    return prefix.count == 2 ? index.table.byPrefix2[prefix.value] : index.table.byPrefix3[prefix.value];
+}
+
+std::uint16_t CountryCatalog::findId(std::string_view barcode)
+{
+    return lookup(*snapshot.readOrCreate(&CountryCatalog::buildIndex), barcode);
+}
+
+std::uint16_t CountryCatalog::findId(QStringView barcode)
+{
+    return lookup(*snapshot.readOrCreate(&CountryCatalog::buildIndex), barcode);
+}
+
+QString CountryCatalog::name(std::uint16_t id)
+{
+    auto index = snapshot.readOrCreate(&CountryCatalog::buildIndex);
+    return id != kNoCountry && id <= index->names.size() ? index->names[id - 1] : QString();
+}
+
+std::string CountryCatalog::nameUtf8(std::uint16_t id)
+{
+    auto index = snapshot.readOrCreate(&CountryCatalog::buildIndex);
+    const auto& names = index->table.names;
+    return id != kNoCountry && id <= names.size() ? names[id - 1] : std::string();
+}
+
+QString CountryCatalog::findName(QStringView barcode)
+{
+    auto index = snapshot.readOrCreate(&CountryCatalog::buildIndex);
+    const std::uint16_t id = lookup(*index, barcode);
+    return id != kNoCountry ? index->names[id - 1] : QString();
+}
+
+std::string CountryCatalog::findNameUtf8(std::string_view barcode)
+{
+    auto index = snapshot.readOrCreate(&CountryCatalog::buildIndex);
+    const std::uint16_t id = lookup(*index, barcode);
+    return id != kNoCountry ? index->table.names[id - 1] : std::string();
+}
+
+int CountryCatalog::digitCount(QStringView barcode)
+{
+    return digitPrefix(barcode).count;
+}
+
+void CountryCatalog::reload()
+{
+    snapshot.publish(buildIndex());
+}
+
+std::unique_ptr<const CountryCatalog::Index> CountryCatalog::buildIndex()
+{
+    auto index = std::make_unique<Index>();
+    if (auto compiled = CompiledCatalog::defaultCatalog()) {
+        index->table = compiled->countryTable();
+    } else {
+        index->table = loadFromFile("C:/Users/rauko/Desktop/BarcodeScanner/data/Barcode_Countries.txt");
+    }
+
+    index->names.reserve(index->table.names.size());
+    for (const auto& countryName : index->table.names) {
+        index->names.push_back(QString::fromStdString(countryName));
+    }
+    return index;
+}
+
+CountryPrefixTable CountryCatalog::loadFromFile(const QString& filePath)
+{
+    QFile file(filePath);
+    if (!file.open(QIODevice::ReadOnly)) {
+        throw FileException("Не удалось открыть файл стран: " + filePath.toStdString());
+    }
+
+    const QByteArray content = file.readAll();
+    CountryPrefixTable table = CountryPrefixTable::parse(
+        std::string_view(content.constData(), static_cast<std::size_t>(content.size())));
+
+    std::cout << "Таблица префиксов стран построена: " << table.names.size() << " стран" << std::endl;
+    return table;
+}
+
+// 📂 Разбор файла стран: "460-469:Россия" или "471:Тайвань".
+// Правила применяются в порядке файла, первое совпадение побеждает — как при построчном поиске
+CountryPrefixTable CountryPrefixTable::parse(std::string_view text)
+{
+    CountryPrefixTable table;
+    std::unordered_map<std::string_view, std::uint16_t> internedIds;
+
+    // Заполняем только свободные ячейки диапазона [first, last]
+    auto assign = [](auto& prefixes, int first, int last, std::uint16_t id) {
+        first = std::max(first, 0);
+        last = std::min(last, static_cast<int>(prefixes.size()) - 1);
+        for (int prefix = first; prefix <= last; ++prefix) {
+            if (prefixes[prefix] == CountryCatalog::kNoCountry) prefixes[prefix] = id;
+        }
+    };
+
+    forEachCatalogLine(text, [&](std::string_view line) {
+        const auto colonPos = line.find(':');
+        if (colonPos == std::string_view::npos) return;
+
+        const std::string_view codes = trimmedView(line.substr(0, colonPos));
+        const std::string_view countryName = trimmedView(line.substr(colonPos + 1));
+
+        auto [it, inserted] = internedIds.try_emplace(countryName, static_cast<std::uint16_t>(table.names.size() + 1));
+        if (inserted) {
+            table.names.emplace_back(countryName);
+        }
+        const std::uint16_t id = it->second;
+
+        if (const auto dashPos = codes.find('-'); dashPos != std::string_view::npos) {
+            auto start = parseNumber(codes.substr(0, dashPos));
+            auto end = parseNumber(codes.substr(dashPos + 1));
+            if (!start || !end) return;
+
+            // Диапазон сравнивается и с 3-значным, и с 2-значным префиксом кода
+            assign(table.byPrefix3, *start, *end, id);
+            assign(table.byPrefix3, *start * 10, *end * 10 + 9, id);
+            assign(table.byPrefix2, *start, *end, id);
+        } else {
+            auto code = parseNumber(codes);
+            if (!code || codes.find_first_not_of("0123456789") != std::string_view::npos) return;
+
+            if (codes.size() == 3) {
+                assign(table.byPrefix3, *code, *code, id);
+            } else if (codes.size() == 2) {
+                assign(table.byPrefix3, *code * 10, *code * 10 + 9, id);
+                assign(table.byPrefix2, *code, *code, id);
+            }
+        }
+    });
+
+    return table;
+}
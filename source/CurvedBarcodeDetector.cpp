@@ -1,68 +1,258 @@
 #include "CurvedBarcodeDetector.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <optional>
 #include <iostream>
 
-std::vector<cv::Rect> CurvedBarcodeDetector::detectCurvedBarcodesOptimized(const cv::Mat& frame) const{
-    std::vector<cv::Rect> curved_regions;
+namespace {
+
+// Поиск ведётся на самом грубом уровне пирамиды, где короткая сторона не меньше 240
+// (для кадра 640x480 это прежние 320x240); чем больше кадр, тем больше уровней
+constexpr int kDetectionShortSide = 240;
+// Уточнение рамки на более точных уровнях — пока регион на уровне не больше этой площади
+constexpr int kMaxRefineArea = 512 * 512;
+// Меньший наклон ZBar читает и так — регион не поворачивается
+constexpr double kMinRotationDegrees = 10.0;
+
+cv::Rect scaleRect(const cv::Rect& source, const cv::Size& from, const cv::Size& to) {
+    const double scale_x = (double)to.width / from.width;
+    const double scale_y = (double)to.height / from.height;
+    const cv::Rect scaled(cvFloor(source.x * scale_x), cvFloor(source.y * scale_y),
+                          cvCeil(source.width * scale_x), cvCeil(source.height * scale_y));
+    return scaled & cv::Rect(cv::Point(0, 0), to);
+}
 
-    cv::Mat small_frame;
-    cv::resize(frame, small_frame, cv::Size(320, 240));
+} // namespace
 
-    cv::Mat gray;
-    cv::cvtColor(small_frame, gray, cv::COLOR_BGR2GRAY);
+int CurvedBarcodeDetector::detectionLevel(const cv::Size& frame_size) const{
+    const int shorter = std::min(frame_size.width, frame_size.height);
+    int level = 0;
+    while ((shorter >> (level + 1)) >= kDetectionShortSide) ++level;
+    return level;
+}
 
-    std::vector<cv::Mat> binary_images;
+std::vector<CurvedRegion> CurvedBarcodeDetector::detectCurvedBarcodesOptimized(const FrameContext& frame) const{
+    std::vector<CurvedRegion> curved_regions;
+
+    // Уровни пирамиды сохраняют пропорции кадра
+    const int coarse_level = detectionLevel(frame.size());
+    const cv::Mat& gray = frame.pyramidLevel(coarse_level);
+    const cv::Size small_size = gray.size();
+    std::cout << "Поиск изогнутых регионов: уровень " << coarse_level << " (" << small_size.width << "x"
+              << small_size.height << ")" << std::endl;
+
+    const FrameContext::Gradients& gradients = frame.levelGradients(coarse_level);
+    std::vector<CurvedRegion> candidates = contourCandidates(computeBinaryMasks(gray), gradients);
+
+    const std::size_t candidate_count = candidates.size();
+    for (auto& region : suppressOverlappingRegions(std::move(candidates), small_size)) {
+        // Уточнение рамки ищет вертикальные штрихи — повёрнутый регион только масштабируется
+        region.rect = region.angle == 0.0 ? refineRegion(frame, region.rect, coarse_level)
+                                          : scaleRect(region.rect, small_size, frame.size());
+        curved_regions.push_back(region);
+    }
+    std::cout << "Кандидатов изогнутых регионов: " << candidate_count << ", после подавления: "
+              << curved_regions.size() << std::endl;
+
+    return curved_regions;
+}
 
-    // Исправлено: каждая переменная в отдельной строке
-    cv::Mat binary1;
-    cv::Mat binary2;
-    cv::Mat binary3;
+// Рамка с уровня level переносится на уровень ниже и уточняется там только внутри себя;
+// когда регион становится слишком большим для уточнения, оставшийся масштаб применяется как есть
+cv::Rect CurvedBarcodeDetector::refineRegion(const FrameContext& frame, cv::Rect rect, int level) const{
+    cv::Size level_size = frame.pyramidLevel(level).size();
+    while (level > 0) {
+        const cv::Mat& finer = frame.pyramidLevel(level - 1);
+        const cv::Rect scaled = scaleRect(rect, level_size, finer.size());
+        if (scaled.area() > kMaxRefineArea || scaled.empty()) break;
+
+        rect = scaled;
+        if (auto tightened = tightenRegion(finer(scaled))) {
+            rect = *tightened + scaled.tl();
+        }
+        level_size = finer.size();
+        --level;
+    }
 
-    cv::adaptiveThreshold(gray, binary1, 255, cv::ADAPTIVE_THRESH_GAUSSIAN_C,
-                          cv::THRESH_BINARY, 21, 5);
-    cv::adaptiveThreshold(gray, binary2, 255, cv::ADAPTIVE_THRESH_GAUSSIAN_C,
-                          cv::THRESH_BINARY, 31, 10);
-    cv::threshold(gray, binary3, 0, 255, cv::THRESH_BINARY | cv::THRESH_OTSU);
+    return level > 0 ? scaleRect(rect, level_size, frame.size()) : rect;
+}
 
-    binary_images.push_back(binary1);
-    binary_images.push_back(binary2);
-    binary_images.push_back(binary3);
+// Рамка штрихов внутри региона: пиксели, где горизонтальный перепад сильный и вдвое сильнее
+// вертикального, смыкаются по горизонтали; берётся самый крупный блок
+std::optional<cv::Rect> CurvedBarcodeDetector::tightenRegion(const cv::Mat& roi) const{
+    if (roi.cols < 16 || roi.rows < 8) return std::nullopt;
 
-    // Исправлено: каждая переменная в отдельной строке
     cv::Mat grad_x;
     cv::Mat grad_y;
+    cv::Sobel(roi, grad_x, CV_16S, 1, 0, 3);
+    cv::Sobel(roi, grad_y, CV_16S, 0, 1, 3);
+
+    cv::Mat stripes(roi.rows, roi.cols, CV_8UC1);
+    for (int y = 0; y < roi.rows; ++y) {
+        const short* gx = grad_x.ptr<short>(y);
+        const short* gy = grad_y.ptr<short>(y);
+        uchar* out = stripes.ptr<uchar>(y);
+        for (int x = 0; x < roi.cols; ++x) {
+            const int strength_x = std::abs(gx[x]);
+            out[x] = strength_x > 160 && strength_x > 2 * std::abs(gy[x]) ? 255 : 0;
+        }
+    }
 
-    cv::Sobel(gray, grad_x, CV_16S, 1, 0, 3);
-    cv::Sobel(gray, grad_y, CV_16S, 0, 1, 3);
-    cv::convertScaleAbs(grad_x, grad_x);
-    cv::convertScaleAbs(grad_y, grad_y);
+    // Зазор между штрихами — до нескольких модулей; ширина кода — около 1/1.4 региона
+    const int close_width = std::max(5, roi.cols / 16);
+    cv::morphologyEx(stripes, stripes, cv::MORPH_CLOSE, cv::getStructuringElement(cv::MORPH_RECT, cv::Size(close_width, 1)));
+    cv::morphologyEx(stripes, stripes, cv::MORPH_OPEN, cv::getStructuringElement(cv::MORPH_RECT, cv::Size(1, 3)));
 
-    cv::Mat gradients;
-    cv::addWeighted(grad_x, 0.5, grad_y, 0.5, 0, gradients);
-    cv::threshold(gradients, gradients, 50, 255, cv::THRESH_BINARY);
-    binary_images.push_back(gradients);
+    std::vector<std::vector<cv::Point>> contours;
+    cv::findContours(stripes, contours, cv::RETR_EXTERNAL, cv::CHAIN_APPROX_SIMPLE);
 
-    for (const auto& binary : binary_images) {
-        std::vector<cv::Rect> contour_regions = extractRegionsFromContours(binary, small_frame.size());
-        curved_regions.insert(curved_regions.end(), contour_regions.begin(), contour_regions.end());
+    cv::Rect best;
+    for (const auto& contour : contours) {
+        const cv::Rect bbox = cv::boundingRect(contour);
+        if (bbox.area() > best.area()) best = bbox;
     }
+    if (best.width < roi.cols / 4 || best.height < 4) return std::nullopt;
 
-    curved_regions = removeDuplicateRegions(curved_regions);
+    return expandBarcodeRegion(best, roi.size());
+}
 
-    double scale_x = (double)frame.cols / small_frame.cols;
-    double scale_y = (double)frame.rows / small_frame.rows;
+// Маски независимы — контуры ищутся параллельно, результаты склеиваются в прежнем порядке
+std::vector<CurvedRegion> CurvedBarcodeDetector::contourCandidates(const std::array<cv::Mat, 4>& masks,
+                                                                   const FrameContext::Gradients& gradients) const{
+    const cv::Size image_size = masks[0].size();
+    std::array<std::vector<CurvedRegion>, 4> contour_regions;
+    cv::parallel_for_(cv::Range(0, static_cast<int>(masks.size())), [&](const cv::Range& range) {
+        for (int i = range.start; i < range.end; ++i) {
+            contour_regions[i] = extractRegionsFromContours(masks[i], image_size, gradients);
+        }
+    });
 
-    for (auto& bbox : curved_regions) {
-        bbox.x = (int)(bbox.x * scale_x);
-        bbox.y = (int)(bbox.y * scale_y);
-        bbox.width = (int)(bbox.width * scale_x);
-        bbox.height = (int)(bbox.height * scale_y);
+    std::vector<CurvedRegion> candidates;
+    for (const auto& regions : contour_regions) {
+        candidates.insert(candidates.end(), regions.begin(), regions.end());
     }
+    return candidates;
+}
 
-    return curved_regions;
+namespace {
+
+// Порог Otsu по гистограмме: максимум межклассовой дисперсии (пиксели > порога — белые)
+int otsuThreshold(const std::array<int, 256>& histogram, int total) {
+    double sum = 0.0;
+    for (int level = 0; level < 256; ++level) sum += static_cast<double>(level) * histogram[level];
+
+    double sum_background = 0.0;
+    int weight_background = 0;
+    double best_variance = -1.0;
+    int threshold = 0;
+    for (int level = 0; level < 256; ++level) {
+        weight_background += histogram[level];
+        if (weight_background == 0) continue;
+        const int weight_foreground = total - weight_background;
+        if (weight_foreground == 0) break;
+
+        sum_background += static_cast<double>(level) * histogram[level];
+        const double mean_background = sum_background / weight_background;
+        const double mean_foreground = (sum - sum_background) / weight_foreground;
+        const double variance = static_cast<double>(weight_background) * weight_foreground
+                                * (mean_background - mean_foreground) * (mean_background - mean_foreground);
+        if (variance > best_variance) {
+            best_variance = variance;
+            threshold = level;
+        }
+    }
+    return threshold;
 }
 
-std::vector<cv::Rect> CurvedBarcodeDetector::extractRegionsFromContours(const cv::Mat& binary, const cv::Size& image_size) const{
-    std::vector<cv::Rect> regions;
+// Индекс соседа с отражением от края (как BORDER_REFLECT_101 у Sobel)
+inline int reflect101(int index, int size) {
+    if (index < 0) return size > 1 ? 1 : 0;
+    if (index >= size) return size > 1 ? size - 2 : size - 1;
+    return index;
+}
+
+} // namespace
+
+// Адаптивные пороги считаются по среднему в окне из интегрального изображения (окно у края
+// обрезается), а не по гауссову среднему adaptiveThreshold: так все маски получаются за один
+// проход. Градиентная маска повторяет Sobel 3x3 + convertScaleAbs + addWeighted(0.5, 0.5) > 50
+std::array<cv::Mat, 4> CurvedBarcodeDetector::computeBinaryMasks(const cv::Mat& gray) const{
+    const int rows = gray.rows;
+    const int cols = gray.cols;
+    std::array<cv::Mat, 4> masks;
+    for (auto& mask : masks) mask.create(rows, cols, CV_8UC1);
+    if (rows == 0 || cols == 0) return masks;
+
+    // Проход 1: интегральное изображение и гистограмма
+    cv::Mat integral_image(rows + 1, cols + 1, CV_32SC1, cv::Scalar(0));
+    std::array<int, 256> histogram{};
+    for (int y = 0; y < rows; ++y) {
+        const uchar* src = gray.ptr<uchar>(y);
+        const std::int32_t* above = integral_image.ptr<std::int32_t>(y);
+        std::int32_t* current = integral_image.ptr<std::int32_t>(y + 1);
+        std::int32_t row_sum = 0;
+        for (int x = 0; x < cols; ++x) {
+            row_sum += src[x];
+            current[x + 1] = above[x + 1] + row_sum;
+            ++histogram[src[x]];
+        }
+    }
+    const int otsu = otsuThreshold(histogram, rows * cols);
+
+    struct AdaptiveWindow {
+        int radius;
+        int offset;   // C из adaptiveThreshold
+    };
+    constexpr AdaptiveWindow kWindows[2] = { { 10, 5 }, { 15, 10 } };   // блоки 21 и 31
+
+    // Проход 2: все маски по строке за раз
+    for (int y = 0; y < rows; ++y) {
+        const uchar* up = gray.ptr<uchar>(reflect101(y - 1, rows));
+        const uchar* mid = gray.ptr<uchar>(y);
+        const uchar* down = gray.ptr<uchar>(reflect101(y + 1, rows));
+        uchar* out[4] = { masks[0].ptr<uchar>(y), masks[1].ptr<uchar>(y), masks[2].ptr<uchar>(y), masks[3].ptr<uchar>(y) };
+
+        const std::int32_t* window_top[2];
+        const std::int32_t* window_bottom[2];
+        int window_height[2];
+        for (int w = 0; w < 2; ++w) {
+            const int y0 = std::max(0, y - kWindows[w].radius);
+            const int y1 = std::min(rows, y + kWindows[w].radius + 1);
+            window_top[w] = integral_image.ptr<std::int32_t>(y0);
+            window_bottom[w] = integral_image.ptr<std::int32_t>(y1);
+            window_height[w] = y1 - y0;
+        }
+
+        for (int x = 0; x < cols; ++x) {
+            const int value = mid[x];
+
+            for (int w = 0; w < 2; ++w) {
+                const int x0 = std::max(0, x - kWindows[w].radius);
+                const int x1 = std::min(cols, x + kWindows[w].radius + 1);
+                const std::int64_t sum = static_cast<std::int64_t>(window_bottom[w][x1]) - window_top[w][x1]
+                                         - window_bottom[w][x0] + window_top[w][x0];
+                const std::int64_t area = static_cast<std::int64_t>(x1 - x0) * window_height[w];
+                // value > sum / area - C без деления
+                out[w][x] = value * area > sum - kWindows[w].offset * area ? 255 : 0;
+            }
+
+            out[2][x] = value > otsu ? 255 : 0;
+
+            const int left = reflect101(x - 1, cols);
+            const int right = reflect101(x + 1, cols);
+            const int grad_x = (up[right] + 2 * mid[right] + down[right]) - (up[left] + 2 * mid[left] + down[left]);
+            const int grad_y = (down[left] + 2 * down[x] + down[right]) - (up[left] + 2 * up[x] + up[right]);
+            // 0.5 * |gx| + 0.5 * |gy| (каждый насыщен до 255) > 50 с округлением cvRound
+            out[3][x] = std::min(255, std::abs(grad_x)) + std::min(255, std::abs(grad_y)) > 101 ? 255 : 0;
+        }
+    }
+    return masks;
+}
+
+std::vector<CurvedRegion> CurvedBarcodeDetector::extractRegionsFromContours(const cv::Mat& binary, const cv::Size& image_size,
+                                                                             const FrameContext::Gradients& gradients) const{
+    std::vector<CurvedRegion> regions;
 
     cv::Mat morph;
     cv::Mat kernel_horizontal = cv::getStructuringElement(cv::MORPH_RECT, cv::Size(5, 1));
@@ -74,28 +264,49 @@ std::vector<cv::Rect> CurvedBarcodeDetector::extractRegionsFromContours(const cv
     std::vector<std::vector<cv::Point>> contours;
     cv::findContours(morph, contours, cv::RETR_EXTERNAL, cv::CHAIN_APPROX_SIMPLE);
 
+    // Градиенты маски считаются один раз и только если есть хоть один подходящий контур
+    std::optional<GradientIntegrals> integrals;
+
     for (const auto& contour : contours) {
         if (contour.empty()) continue;
 
         cv::Rect bbox = cv::boundingRect(contour);
-        if (isValidBarcodeRegionExtended(bbox, image_size, contour) && hasBarcodeTextureAdvanced(binary(bbox))) {
+        if (!isValidBarcodeRegionExtended(bbox, image_size, contour)) continue;
+        if (!integrals) integrals = computeGradientIntegrals(binary);
+
+        const double texture_score = barcodeTextureScore(*integrals, bbox);
+        if (texture_score > 0.0) {
             cv::Rect expanded_bbox = expandBarcodeRegion(bbox, image_size);
-            regions.push_back(expanded_bbox);
+            regions.push_back({ expanded_bbox, texture_score });
+            continue;
+        }
+
+        // Штрихи не вертикальны — может быть повёрнутый код: регион запоминается с углом,
+        // чтобы повернуть его один раз перед декодированием
+        const BarOrientation orientation = dominantOrientation(gradients, bbox);
+        if (orientation.score > 0.0 && std::abs(orientation.angle) >= kMinRotationDegrees) {
+            regions.push_back({ expandBarcodeRegion(bbox, image_size), orientation.score, orientation.angle });
         }
     }
 
     return regions;
 }
 
+// Размеры и пропорции — по повёрнутому прямоугольнику контура, чтобы код под углом 30–60°
+// с почти квадратной ограничивающей рамкой не отбрасывался
 bool CurvedBarcodeDetector::isValidBarcodeRegionExtended(const cv::Rect& rect, const cv::Size& image_size,
                                                          const std::vector<cv::Point>& contour) const{
-    if (rect.width < 30 || rect.height < 10) return false;
     if (rect.width > image_size.width * 0.7 || rect.height > image_size.height * 0.7) return false;
 
-    double area = rect.width * rect.height;
+    const cv::RotatedRect box = cv::minAreaRect(contour);
+    const double long_side = std::max(box.size.width, box.size.height);
+    const double short_side = std::min(box.size.width, box.size.height);
+    if (long_side < 30 || short_side < 10) return false;
+
+    double area = long_side * short_side;
     if (area < 500) return false;
 
-    double aspect_ratio = (double)rect.width / rect.height;
+    double aspect_ratio = long_side / short_side;
     bool valid_aspect = (aspect_ratio > 1.0 && aspect_ratio < 15.0);
 
     double contour_area = cv::contourArea(contour);
@@ -118,58 +329,227 @@ cv::Rect CurvedBarcodeDetector::expandBarcodeRegion(const cv::Rect& original, co
     return expanded;
 }
 
-std::vector<cv::Rect> CurvedBarcodeDetector::removeDuplicateRegions(const std::vector<cv::Rect>& regions) const{
-    std::vector<cv::Rect> unique_regions;
+std::vector<CurvedRegion> CurvedBarcodeDetector::suppressOverlappingRegions(std::vector<CurvedRegion> regions,
+                                                                             const cv::Size& image_size) const{
+    std::stable_sort(regions.begin(), regions.end(),
+                     [](const CurvedRegion& a, const CurvedRegion& b) { return a.score > b.score; });
+
+    // Ячейка порядка минимального региона (30x10): большой регион занимает несколько ячеек,
+    // зато в каждой мало соседей
+    constexpr int kCellSize = 32;
+    const int grid_cols = std::max(1, (image_size.width + kCellSize - 1) / kCellSize);
+    const int grid_rows = std::max(1, (image_size.height + kCellSize - 1) / kCellSize);
+    std::vector<std::vector<int>> cells(static_cast<std::size_t>(grid_cols) * grid_rows);
+
+    auto cellRange = [&](const cv::Rect& rect) {
+        const int x0 = std::clamp(rect.x / kCellSize, 0, grid_cols - 1);
+        const int y0 = std::clamp(rect.y / kCellSize, 0, grid_rows - 1);
+        const int x1 = std::clamp((rect.x + rect.width - 1) / kCellSize, 0, grid_cols - 1);
+        const int y1 = std::clamp((rect.y + rect.height - 1) / kCellSize, 0, grid_rows - 1);
+        return cv::Rect(x0, y0, x1 - x0 + 1, y1 - y0 + 1);
+    };
+
+    std::vector<CurvedRegion> kept;
+    std::vector<std::size_t> checked_at;   // номер кандидата, для которого принятый регион уже проверен
+
+    for (std::size_t candidate = 0; candidate < regions.size(); ++candidate) {
+        const cv::Rect& rect = regions[candidate].rect;
+        if (rect.area() <= 0) continue;
+        const cv::Rect range = cellRange(rect);
 
-    for (const auto& rect : regions) {
         bool is_duplicate = false;
-
-        for (const auto& existing : unique_regions) {
-            cv::Rect intersection = rect & existing;
-            double overlap = (double)intersection.area() / std::min(rect.area(), existing.area());
-
-            if (overlap > 0.6) {
-                is_duplicate = true;
-                break;
+        for (int cy = range.y; cy < range.y + range.height && !is_duplicate; ++cy) {
+            for (int cx = range.x; cx < range.x + range.width && !is_duplicate; ++cx) {
+                for (int index : cells[static_cast<std::size_t>(cy) * grid_cols + cx]) {
+                    if (checked_at[index] == candidate) continue;
+                    checked_at[index] = candidate;
+
+                    const cv::Rect& existing = kept[index].rect;
+                    double overlap = (double)(rect & existing).area() / std::min(rect.area(), existing.area());
+                    if (overlap > 0.6) {
+                        is_duplicate = true;
+                        break;
+                    }
+                }
             }
         }
-
-        if (!is_duplicate) {
-            unique_regions.push_back(rect);
+        if (is_duplicate) continue;
+
+        const int index = static_cast<int>(kept.size());
+        kept.push_back(regions[candidate]);
+        checked_at.push_back(candidate);
+        for (int cy = range.y; cy < range.y + range.height; ++cy) {
+            for (int cx = range.x; cx < range.x + range.width; ++cx) {
+                cells[static_cast<std::size_t>(cy) * grid_cols + cx].push_back(index);
+            }
         }
     }
 
-    return unique_regions;
+    return kept;
 }
 
-bool CurvedBarcodeDetector::hasBarcodeTextureAdvanced(const cv::Mat& region) const{
-    if (region.empty() || region.rows < 5 || region.cols < 5) return false;
-
-    cv::Mat gray = region;
-    if (region.channels() == 3) {
-        cv::cvtColor(region, gray, cv::COLOR_BGR2GRAY);
-    }
+CurvedBarcodeDetector::GradientIntegrals CurvedBarcodeDetector::computeGradientIntegrals(const cv::Mat& binary) const{
+    GradientIntegrals integrals;
 
-    // Исправлено: каждая переменная в отдельной строке
     cv::Mat grad_x;
     cv::Mat grad_y;
+    cv::Sobel(binary, grad_x, CV_16S, 1, 0, 3);
+    cv::Sobel(binary, grad_y, CV_16S, 0, 1, 3);
 
-    cv::Sobel(gray, grad_x, CV_32F, 1, 0, 3);
-    cv::Sobel(gray, grad_y, CV_32F, 0, 1, 3);
+    cv::integral(grad_x, integrals.sum_x, integrals.sqsum_x, CV_64F, CV_64F);
+    cv::integral(grad_y, integrals.sum_y, integrals.sqsum_y, CV_64F, CV_64F);
+    return integrals;
+}
 
-    // Исправлено: каждая переменная в отдельной строке
-    cv::Scalar mean_x;
-    cv::Scalar stddev_x;
-    cv::Scalar mean_y;
-    cv::Scalar stddev_y;
+namespace {
 
-    cv::meanStdDev(grad_x, mean_x, stddev_x);
-    cv::meanStdDev(grad_y, mean_y, stddev_y);
+double rectSum(const cv::Mat& integral, const cv::Rect& rect) {
+    return integral.at<double>(rect.y + rect.height, rect.x + rect.width) - integral.at<double>(rect.y, rect.x + rect.width)
+           - integral.at<double>(rect.y + rect.height, rect.x) + integral.at<double>(rect.y, rect.x);
+}
+
+// Среднее и стандартное отклонение градиента в прямоугольнике — как meanStdDev по Собелю
+// региона-представления маски: Собель по ROI читает соседние пиксели маски за краем региона,
+// поэтому градиенты всей маски дают те же значения и на краях
+std::pair<double, double> rectMeanStdDev(const cv::Mat& sum, const cv::Mat& sqsum, const cv::Rect& rect) {
+    const double count = static_cast<double>(rect.area());
+    const double mean = rectSum(sum, rect) / count;
+    const double variance = rectSum(sqsum, rect) / count - mean * mean;
+    return { mean, std::sqrt(std::max(0.0, variance)) };
+}
 
-    double horizontal_stripe = stddev_x[0] / (std::abs(mean_x[0]) + 1e-5);
-    double vertical_stripe = stddev_y[0] / (std::abs(mean_y[0]) + 1e-5);
+} // namespace
+
+// Проверка за O(1) по интегральным изображениям маски, без Собеля по каждому кандидату
+double CurvedBarcodeDetector::barcodeTextureScore(const GradientIntegrals& integrals, const cv::Rect& rect) const{
+    const cv::Rect region = rect & cv::Rect(0, 0, integrals.sum_x.cols - 1, integrals.sum_x.rows - 1);
+    if (region.empty() || region.height < 5 || region.width < 5) return 0.0;
+
+    const auto [mean_x, stddev_x] = rectMeanStdDev(integrals.sum_x, integrals.sqsum_x, region);
+    const auto [mean_y, stddev_y] = rectMeanStdDev(integrals.sum_y, integrals.sqsum_y, region);
+
+    double horizontal_stripe = stddev_x / (std::abs(mean_x) + 1e-5);
+    double vertical_stripe = stddev_y / (std::abs(mean_y) + 1e-5);
 
     bool is_barcode_like = (horizontal_stripe > 1.8) && (horizontal_stripe > vertical_stripe * 1.2);
 
-    return is_barcode_like;
+    // Чем сильнее горизонтальная полосатость преобладает над вертикальной, тем выше оценка
+    return is_barcode_like ? horizontal_stripe / (vertical_stripe + 1e-5) : 0.0;
+}
+
+// Угол — как у getRotationMatrix2D: поворот на него делает градиент горизонтальным, штрихи — вертикальными
+CurvedBarcodeDetector::BarOrientation CurvedBarcodeDetector::dominantOrientation(const FrameContext::Gradients& gradients,
+                                                                                 const cv::Rect& rect) const{
+    constexpr int kBins = 36;
+    constexpr double kBinDegrees = 180.0 / kBins;
+    constexpr int kMinMagnitude = 64;   // слабые перепады — шум фона
+
+    const cv::Rect region = rect & cv::Rect(0, 0, gradients.dx.cols, gradients.dx.rows);
+    if (region.empty()) return {};
+
+    std::array<double, kBins> histogram{};
+    double total = 0.0;
+    for (int y = region.y; y < region.y + region.height; ++y) {
+        const short* gx = gradients.dx.ptr<short>(y);
+        const short* gy = gradients.dy.ptr<short>(y);
+        for (int x = region.x; x < region.x + region.width; ++x) {
+            const int magnitude = std::abs(gx[x]) + std::abs(gy[x]);
+            if (magnitude < kMinMagnitude) continue;
+
+            double degrees = std::atan2(static_cast<double>(gy[x]), static_cast<double>(gx[x])) * 180.0 / CV_PI;
+            if (degrees < 0.0) degrees += 180.0;
+            // Корзина 0 — с центром в 0°, чтобы вертикальные штрихи не делились между 0 и 35
+            histogram[static_cast<int>(degrees / kBinDegrees + 0.5) % kBins] += magnitude;
+            total += magnitude;
+        }
+    }
+    if (total <= 0.0) return {};
+
+    auto bin = [&histogram](int index) { return histogram[(index % kBins + kBins) % kBins]; };
+    auto smoothed = [&bin](int index) { return bin(index - 1) + 2.0 * bin(index) + bin(index + 1); };
+
+    int peak = 0;
+    for (int index = 1; index < kBins; ++index) {
+        if (smoothed(index) > smoothed(peak)) peak = index;
+    }
+
+    // Вес пика и перпендикулярного направления — в окне ±15°
+    double peak_weight = 0.0;
+    double perpendicular_weight = 0.0;
+    for (int offset = -3; offset <= 3; ++offset) {
+        peak_weight += bin(peak + offset);
+        perpendicular_weight += bin(peak + kBins / 2 + offset);
+    }
+    if (peak_weight < 0.5 * total || peak_weight < 3.0 * perpendicular_weight) return {};
+
+    // Уточнение пика параболой по сглаженной гистограмме
+    const double left = smoothed(peak - 1);
+    const double center = smoothed(peak);
+    const double right = smoothed(peak + 1);
+    const double denominator = left - 2.0 * center + right;
+    const double shift = denominator != 0.0 ? 0.5 * (left - right) / denominator : 0.0;
+
+    double angle = (peak + shift) * kBinDegrees;
+    if (angle > 90.0) angle -= 180.0;
+    return { angle, peak_weight / (perpendicular_weight + 1e-5) };
+}
+
+std::vector<CurvedRegion> CurvedBarcodeDetector::rankRegions(const FrameContext& frame,
+                                                           const std::vector<CurvedRegion>& regions) const{
+    std::vector<CurvedRegion> ranked;
+    ranked.reserve(regions.size());
+
+    for (const auto& region : regions) {
+        ranked.push_back({ region.rect, scoreRegion(frame, region.rect, region.angle), region.angle });
+    }
+
+    std::stable_sort(ranked.begin(), ranked.end(),
+                     [](const CurvedRegion& a, const CurvedRegion& b) { return a.score > b.score; });
+    return ranked;
+}
+
+// Оценка региона: штрихи вертикальны, поэтому у штрих-кода горизонтальный градиент
+// заметно сильнее вертикального, а перепадов много. Считается на копии шириной до 128 пикселей,
+// вырезанной из уровня пирамиды, где регион ещё не уже этой ширины; повёрнутый регион
+// сначала разворачивается штрихами вертикально
+double CurvedBarcodeDetector::scoreRegion(const FrameContext& frame, const cv::Rect& rect, double angle) const{
+    const cv::Rect clipped = rect & cv::Rect(cv::Point(0, 0), frame.size());
+    if (clipped.width < 5 || clipped.height < 5) return 0.0;
+
+    constexpr int kScoreWidth = 128;
+    int level = 0;
+    while ((clipped.width >> (level + 1)) >= kScoreWidth && (clipped.height >> (level + 1)) >= 3) ++level;
+
+    const cv::Mat& layer = frame.pyramidLevel(level);
+    const double factor = (double)layer.cols / frame.size().width;
+    const cv::Rect scaled = cv::Rect(cvRound(clipped.x * factor), cvRound(clipped.y * factor),
+                                     cvRound(clipped.width * factor), cvRound(clipped.height * factor))
+                            & cv::Rect(0, 0, layer.cols, layer.rows);
+    if (scaled.width < 3 || scaled.height < 3) return 0.0;
+
+    cv::Mat roi = layer(scaled);
+    if (roi.cols > kScoreWidth) {
+        const double scale = (double)kScoreWidth / roi.cols;
+        cv::resize(roi, roi, cv::Size(), scale, scale, cv::INTER_AREA);
+    }
+    if (roi.rows < 3 || roi.cols < 3) return 0.0;
+    if (angle != 0.0) {
+        const cv::Point2f center((roi.cols - 1) * 0.5f, (roi.rows - 1) * 0.5f);
+        cv::warpAffine(roi, roi, cv::getRotationMatrix2D(center, angle, 1.0), roi.size(), cv::INTER_LINEAR,
+                       cv::BORDER_REPLICATE);
+    }
+
+    cv::Mat grad_x;
+    cv::Mat grad_y;
+    cv::Sobel(roi, grad_x, CV_32F, 1, 0, 3);
+    cv::Sobel(roi, grad_y, CV_32F, 0, 1, 3);
+
+    const double energy_x = cv::sum(cv::abs(grad_x))[0];
+    const double energy_y = cv::sum(cv::abs(grad_y))[0];
+
+    // Преобладание горизонтального градиента [0, 1] и его средняя сила, нормированная к "уверенному" контрасту
+    const double dominance = std::max(0.0, (energy_x - energy_y) / (energy_x + energy_y + 1e-5));
+    const double strength = std::min(1.0, energy_x / roi.total() / 200.0);
+
+    return dominance * strength;
 }
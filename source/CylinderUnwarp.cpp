@@ -0,0 +1,275 @@
+#include "CylinderUnwarp.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <vector>
+
+namespace {
+
+constexpr int kWrapStepDegrees = 5;
+constexpr int kMaxWrapDegrees = 80;
+// Столько полос по высоте сравнивается со средней при оценке наклона и дуги
+constexpr int kSlantBands = 8;
+// Угол принимается, только если заметно выравнивает интервалы относительно плоского случая
+constexpr double kWrapGain = 0.7;
+constexpr int kMaxSlant = 127;
+
+double radians(int degrees) {
+    return degrees * CV_PI / 180.0;
+}
+
+// Горизонтальный профиль яркости полосы строк [top, bottom)
+std::vector<float> intensityProfile(const cv::Mat& gray, int top, int bottom) {
+    std::vector<float> profile(gray.cols, 0.0f);
+    for (int y = top; y < bottom; ++y) {
+        const uchar* row = gray.ptr<uchar>(y);
+        for (int x = 0; x < gray.cols; ++x) profile[x] += row[x];
+    }
+    for (auto& value : profile) value /= static_cast<float>(bottom - top);
+    return profile;
+}
+
+// Края штрихов: пересечения профиля с серединой между минимумом и максимумом, с субпиксельной точностью
+std::vector<double> profileCrossings(const std::vector<float>& profile) {
+    const auto [low, high] = std::minmax_element(profile.begin(), profile.end());
+    const float threshold = (*low + *high) * 0.5f;
+
+    std::vector<double> crossings;
+    for (std::size_t x = 1; x < profile.size(); ++x) {
+        const float before = profile[x - 1] - threshold;
+        const float after = profile[x] - threshold;
+        if ((before < 0) != (after < 0)) {
+            crossings.push_back(x - 1 + before / (before - after));
+        }
+    }
+    return crossings;
+}
+
+// Насколько интервалы между краями кратны общему модулю: 0 — идеально.
+// Модуль затравочно — 20-й перцентиль интервалов (одномодульных элементов в кодах много),
+// затем уточняется по сумме интервалов и числу модулей
+double moduleIrregularity(const std::vector<double>& positions) {
+    std::vector<double> spacings;
+    spacings.reserve(positions.size());
+    for (std::size_t i = 1; i < positions.size(); ++i) {
+        if (positions[i] > positions[i - 1]) spacings.push_back(positions[i] - positions[i - 1]);
+    }
+    if (spacings.size() < 8) return std::numeric_limits<double>::infinity();
+
+    std::vector<double> sorted = spacings;
+    auto percentile = sorted.begin() + sorted.size() / 5;
+    std::nth_element(sorted.begin(), percentile, sorted.end());
+    double module = *percentile;
+
+    double irregularity = 0.0;
+    for (int pass = 0; pass < 2; ++pass) {
+        double total = 0.0;
+        double modules = 0.0;
+        irregularity = 0.0;
+        for (double spacing : spacings) {
+            const double count = std::max(1.0, std::round(spacing / module));
+            const double error = spacing / module - count;
+            irregularity += error * error;
+            total += spacing;
+            modules += count;
+        }
+        module = total / modules;
+    }
+    return irregularity / spacings.size();
+}
+
+// Угол охвата: края средней полосы переводятся из координат изображения в длину дуги
+// для каждого угла, побеждает угол с самыми регулярными интервалами
+int estimateWrap(const cv::Mat& gray) {
+    const int half_band = std::max(2, gray.rows / 16);
+    const std::vector<double> edges =
+        profileCrossings(intensityProfile(gray, gray.rows / 2 - half_band, gray.rows / 2 + half_band));
+    if (edges.size() < 16) return 0;
+
+    const double center = (gray.cols - 1) * 0.5;
+    const double half_width = gray.cols * 0.5;
+    std::vector<double> normalized(edges.size());
+    for (std::size_t i = 0; i < edges.size(); ++i) normalized[i] = (edges[i] - center) / half_width;
+
+    const double flat = moduleIrregularity(normalized);
+    double best = flat;
+    int best_degrees = 0;
+    std::vector<double> unrolled(normalized.size());
+    for (int degrees = kWrapStepDegrees; degrees <= kMaxWrapDegrees; degrees += kWrapStepDegrees) {
+        const double angle = radians(degrees);
+        const double sin_angle = std::sin(angle);
+        for (std::size_t i = 0; i < normalized.size(); ++i) {
+            unrolled[i] = std::asin(std::clamp(normalized[i] * sin_angle, -1.0, 1.0)) / angle;
+        }
+        const double irregularity = moduleIrregularity(unrolled);
+        if (irregularity < best) {
+            best = irregularity;
+            best_degrees = degrees;
+        }
+    }
+    return best < kWrapGain * flat ? best_degrees : 0;
+}
+
+// Сдвиг profile относительно reference, при котором они лучше всего совпадают
+int bestShift(const std::vector<float>& reference, const std::vector<float>& profile, int max_shift) {
+    const int length = static_cast<int>(reference.size());
+    double best = -1.0;
+    int best_shift = 0;
+    for (int shift = -max_shift; shift <= max_shift; ++shift) {
+        const int from = std::max(0, -shift);
+        const int to = length - std::max(0, shift);
+        double correlation = 0.0;
+        for (int x = from; x < to; ++x) correlation += reference[x] * profile[x + shift];
+        correlation /= to - from;
+        if (correlation > best) {
+            best = correlation;
+            best_shift = shift;
+        }
+    }
+    return best_shift;
+}
+
+// Наклон и дуга: сдвиг каждой полосы относительно средней аппроксимируется
+// как shear * dy + bow * dy^2 (dy — расстояние до середины, в долях половины высоты)
+void estimateSlant(const cv::Mat& gray, UnwarpParams& params) {
+    cv::Mat grad_x;
+    cv::Sobel(gray, grad_x, CV_16S, 1, 0, 3);
+
+    auto gradientProfile = [&](int top, int bottom) {
+        std::vector<float> profile(gray.cols, 0.0f);
+        for (int y = top; y < bottom; ++y) {
+            const short* row = grad_x.ptr<short>(y);
+            for (int x = 0; x < gray.cols; ++x) profile[x] += std::abs(row[x]);
+        }
+        return profile;
+    };
+
+    const int margin = gray.rows / 10;
+    const int band_height = (gray.rows - 2 * margin) / kSlantBands;
+    if (band_height < 2) return;
+
+    const double half_height = gray.rows * 0.5;
+    const int middle = gray.rows / 2 - band_height / 2;
+    const std::vector<float> reference = gradientProfile(middle, middle + band_height);
+    const int max_shift = std::max(2, gray.cols / 8);
+
+    // Нормальные уравнения МНК для двух коэффициентов без свободного члена
+    double s11 = 0.0, s12 = 0.0, s22 = 0.0, b1 = 0.0, b2 = 0.0;
+    for (int band = 0; band < kSlantBands; ++band) {
+        const int top = margin + band * band_height;
+        const double dy = (top + band_height * 0.5 - half_height) / half_height;
+        const double shift = bestShift(reference, gradientProfile(top, top + band_height), max_shift);
+        s11 += dy * dy;
+        s12 += dy * dy * dy;
+        s22 += dy * dy * dy * dy;
+        b1 += dy * shift;
+        b2 += dy * dy * shift;
+    }
+    const double determinant = s11 * s22 - s12 * s12;
+    if (std::abs(determinant) < 1e-9) return;
+
+    params.shear = std::clamp(static_cast<int>(std::lround((b1 * s22 - b2 * s12) / determinant)), -kMaxSlant, kMaxSlant);
+    params.bow = std::clamp(static_cast<int>(std::lround((s11 * b2 - s12 * b1) / determinant)), -kMaxSlant, kMaxSlant);
+}
+
+} // namespace
+
+cv::Point2f UnwarpParams::sourcePoint(cv::Point2f point) const {
+    const float center_x = (width - 1) * 0.5f;
+    const float half_width = width * 0.5f;
+    const float center_y = (height - 1) * 0.5f;
+    const float half_height = height * 0.5f;
+
+    float x = point.x;
+    if (wrapDegrees != 0) {
+        const float angle = static_cast<float>(radians(wrapDegrees));
+        x = center_x + half_width * std::sin((point.x - center_x) / half_width * angle) / std::sin(angle);
+    }
+    const float dy = (point.y - center_y) / half_height;
+    return { x + shear * dy + bow * dy * dy, point.y };
+}
+
+std::uint64_t UnwarpParams::key() const {
+    return (static_cast<std::uint64_t>(width) << 40) | (static_cast<std::uint64_t>(height) << 24)
+           | (static_cast<std::uint64_t>(wrapDegrees) << 16)
+           | (static_cast<std::uint64_t>(shear + 128) << 8) | static_cast<std::uint64_t>(bow + 128);
+}
+
+UnwarpParams estimateUnwarp(const cv::Mat& gray) {
+    UnwarpParams params;
+    params.width = gray.cols;
+    params.height = gray.rows;
+    params.wrapDegrees = estimateWrap(gray);
+    estimateSlant(gray, params);
+    return params;
+}
+
+UnwarpMapCache& UnwarpMapCache::instance() {
+    static UnwarpMapCache cache;
+    return cache;
+}
+
+UnwarpMapCache::UnwarpMapCache(std::size_t capacity)
+    : capacity(std::max<std::size_t>(capacity, 1)) {
+    byKey.reserve(this->capacity);
+}
+
+std::shared_ptr<const RemapTables> UnwarpMapCache::build(const UnwarpParams& params) {
+    cv::Mat map_x(params.height, params.width, CV_32FC1);
+    cv::Mat map_y(params.height, params.width, CV_32FC1);
+    for (int y = 0; y < params.height; ++y) {
+        float* xs = map_x.ptr<float>(y);
+        float* ys = map_y.ptr<float>(y);
+        for (int x = 0; x < params.width; ++x) {
+            const cv::Point2f source = params.sourcePoint(cv::Point2f(static_cast<float>(x), static_cast<float>(y)));
+            xs[x] = source.x;
+            ys[x] = source.y;
+        }
+    }
+
+    auto tables = std::make_shared<RemapTables>();
+    cv::convertMaps(map_x, map_y, tables->map1, tables->map2, CV_16SC2);
+    return tables;
+}
+
+std::shared_ptr<const RemapTables> UnwarpMapCache::tables(const UnwarpParams& params) {
+    const std::uint64_t key = params.key();
+    {
+        std::lock_guard lock(mutex);
+        if (auto it = byKey.find(key); it != byKey.end()) {
+            entries.splice(entries.begin(), entries, it->second);
+            hitCount.fetch_add(1, std::memory_order_relaxed);
+            return it->second->tables;
+        }
+    }
+    missCount.fetch_add(1, std::memory_order_relaxed);
+
+    // Таблицы строятся без блокировки; если другой поток успел раньше, берутся его
+    std::shared_ptr<const RemapTables> built = build(params);
+
+    std::lock_guard lock(mutex);
+    if (auto it = byKey.find(key); it != byKey.end()) {
+        entries.splice(entries.begin(), entries, it->second);
+        return it->second->tables;
+    }
+    if (entries.size() >= capacity) {
+        byKey.erase(entries.back().key);
+        entries.pop_back();
+    }
+    entries.push_front({ key, built });
+    byKey.emplace(key, entries.begin());
+    return built;
+}
+
+UnwarpMapCache::Stats UnwarpMapCache::stats() const {
+    std::lock_guard lock(mutex);
+    return { hitCount.load(std::memory_order_relaxed), missCount.load(std::memory_order_relaxed),
+             entries.size(), capacity };
+}
+
+cv::Mat unwarpRegion(const cv::Mat& gray, const UnwarpParams& params) {
+    const auto tables = UnwarpMapCache::instance().tables(params);
+    cv::Mat unwarped;
+    cv::remap(gray, unwarped, tables->map1, tables->map2, cv::INTER_LINEAR, cv::BORDER_REPLICATE);
+    return unwarped;
+}
@@ -0,0 +1,342 @@
+#include "EanScanlineDecoder.h"
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cmath>
+#include <cstdint>
+#include <iostream>
+#include <numeric>
+#include <string>
+#include <vector>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define EAN_SCANLINE_AVX2 1
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define EAN_SCANLINE_SSE2 1
+#endif
+
+namespace {
+
+using Pattern = std::array<std::uint8_t, 4>;
+using PatternTable = std::array<Pattern, 10>;
+
+// Ширины полос L-кода в модулях: пробел, штрих, пробел, штрих
+constexpr PatternTable kLPatterns = { { { 3, 2, 1, 1 }, { 2, 2, 2, 1 }, { 2, 1, 2, 2 }, { 1, 4, 1, 1 }, { 1, 1, 3, 2 },
+                                        { 1, 2, 3, 1 }, { 1, 1, 1, 4 }, { 1, 3, 1, 2 }, { 1, 2, 1, 3 }, { 3, 1, 1, 2 } } };
+
+// R-код — инверсия L: те же ширины, но начинается со штриха
+constexpr PatternTable makeRPatterns() {
+    return kLPatterns;
+}
+
+// G-код — R, прочитанный справа налево
+constexpr PatternTable makeGPatterns() {
+    PatternTable table{};
+    for (std::size_t digit = 0; digit < table.size(); ++digit) {
+        for (std::size_t i = 0; i < 4; ++i) table[digit][i] = kLPatterns[digit][3 - i];
+    }
+    return table;
+}
+
+constexpr PatternTable kRPatterns = makeRPatterns();
+constexpr PatternTable kGPatterns = makeGPatterns();
+
+// Чётность левой половины EAN-13 по первой цифре: бит 5 — первая цифра половины, 1 — G-код
+constexpr std::array<std::uint8_t, 10> kParity = { 0b000000, 0b001011, 0b001101, 0b001110, 0b010011,
+                                                  0b011001, 0b011100, 0b010101, 0b010110, 0b011010 };
+
+// Обратная таблица: маска чётности -> первая цифра (-1 — такой маски нет)
+constexpr std::array<std::int8_t, 64> makeFirstDigitByParity() {
+    std::array<std::int8_t, 64> lookup{};
+    for (auto& digit : lookup) digit = -1;
+    for (std::size_t digit = 0; digit < kParity.size(); ++digit) lookup[kParity[digit]] = static_cast<std::int8_t>(digit);
+    return lookup;
+}
+
+constexpr auto kFirstDigitByParity = makeFirstDigitByParity();
+
+static_assert(kGPatterns[0] == Pattern{ 1, 1, 2, 3 });
+static_assert(kFirstDigitByParity[0b001011] == 1 && kFirstDigitByParity[0b111111] == -1);
+
+// Число полос (штрихов и пробелов) от начала стартового до конца стопового ограничителя
+constexpr int kEan13Runs = 3 + 6 * 4 + 5 + 6 * 4 + 3;
+constexpr int kEan8Runs = 3 + 4 * 4 + 5 + 4 * 4 + 3;
+constexpr int kEan13Modules = 95;
+constexpr int kEan8Modules = 67;
+
+// Допуски: сумма отклонений ширин цифры от образца (в модулях) и ширина полосы ограничителя
+constexpr float kMaxDigitError = 1.2f;
+constexpr float kMinGuardModules = 0.35f;
+constexpr float kMaxGuardModules = 2.0f;
+constexpr float kQuietZoneModules = 3.0f;
+constexpr int kMinContrast = 24;
+
+// Границы полос для блока до 64 пикселей: dark — маска тёмных пикселей (бит i — пиксель x + i)
+void appendEdges(std::uint64_t dark, int count, int x, std::uint64_t& previousDark, std::vector<int>& edges) {
+    const std::uint64_t valid = count == 64 ? ~0ull : (1ull << count) - 1;
+    std::uint64_t transitions = (dark ^ ((dark << 1) | previousDark)) & valid;
+    while (transitions) {
+        edges.push_back(x + std::countr_zero(transitions));
+        transitions &= transitions - 1;
+    }
+    previousDark = (dark >> (count - 1)) & 1;
+}
+
+// Позиции смены светлый <-> тёмный (тёмный — ниже порога). Перед строкой и после неё
+// считается светлый фон, поэтому чётные границы — начала штрихов и число границ чётно
+void findEdges(const std::uint8_t* row, int width, std::uint8_t threshold, std::vector<int>& edges) {
+    edges.clear();
+    std::uint64_t previousDark = 0;
+    int x = 0;
+
+#if defined(EAN_SCANLINE_AVX2)
+    const __m256i limit = _mm256_set1_epi8(static_cast<char>(threshold));
+    const __m256i zero = _mm256_setzero_si256();
+    for (; x + 32 <= width; x += 32) {
+        const __m256i pixels = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(row + x));
+        // limit - pixel с насыщением равно нулю ровно для светлых пикселей
+        const __m256i light = _mm256_cmpeq_epi8(_mm256_subs_epu8(limit, pixels), zero);
+        const auto dark = static_cast<std::uint32_t>(~_mm256_movemask_epi8(light));
+        appendEdges(dark, 32, x, previousDark, edges);
+    }
+#elif defined(EAN_SCANLINE_SSE2)
+    const __m128i limit = _mm_set1_epi8(static_cast<char>(threshold));
+    const __m128i zero = _mm_setzero_si128();
+    for (; x + 16 <= width; x += 16) {
+        const __m128i pixels = _mm_loadu_si128(reinterpret_cast<const __m128i*>(row + x));
+        const __m128i light = _mm_cmpeq_epi8(_mm_subs_epu8(limit, pixels), zero);
+        const auto dark = static_cast<std::uint32_t>(~_mm_movemask_epi8(light)) & 0xFFFFu;
+        appendEdges(dark, 16, x, previousDark, edges);
+    }
+#endif
+
+    while (x < width) {
+        const int count = std::min(64, width - x);
+        std::uint64_t dark = 0;
+        for (int i = 0; i < count; ++i) {
+            dark |= static_cast<std::uint64_t>(row[x + i] < threshold) << i;
+        }
+        appendEdges(dark, count, x, previousDark, edges);
+        x += count;
+    }
+
+    if (previousDark) edges.push_back(width);
+}
+
+// Уточнение границ до долей пикселя: пиксель на границе полос серый, точка пересечения
+// порога находится линейной интерполяцией между ним и соседом. На модулях в 1-2 пикселя
+// целочисленных границ не хватает, чтобы различить ширины 1-4
+void refineEdges(const std::uint8_t* row, int width, std::uint8_t threshold, const std::vector<int>& edges,
+                 std::vector<float>& positions) {
+    positions.resize(edges.size());
+    for (std::size_t i = 0; i < edges.size(); ++i) {
+        const int x = edges[i];
+        if (x <= 0 || x >= width) {
+            positions[i] = static_cast<float>(x);
+            continue;
+        }
+        const float before = row[x - 1];
+        const float after = row[x];
+        positions[i] = static_cast<float>(x) - 0.5f + (before - threshold) / (before - after);
+    }
+}
+
+// Цифра по четырём полосам: ширины приводятся к 7 модулям и сравниваются с образцами.
+// Возвращает цифру или -1, если ни один образец не подошёл
+int matchDigit(const float* widths, const PatternTable& table, float& error) {
+    const float total = widths[0] + widths[1] + widths[2] + widths[3];
+    if (total <= 0.0f) return -1;
+
+    const float toModules = 7.0f / total;
+    int best = -1;
+    error = kMaxDigitError;
+    for (int digit = 0; digit < 10; ++digit) {
+        float distance = 0.0f;
+        for (int i = 0; i < 4; ++i) distance += std::abs(widths[i] * toModules - table[digit][i]);
+        if (distance < error) {
+            error = distance;
+            best = digit;
+        }
+    }
+    return best;
+}
+
+bool isGuard(const float* widths, int count, float module) {
+    for (int i = 0; i < count; ++i) {
+        if (widths[i] < module * kMinGuardModules || widths[i] > module * kMaxGuardModules) return false;
+    }
+    return true;
+}
+
+bool isCheckDigitValid(const std::string& digits) {
+    // Справа налево, без контрольной: веса 3, 1, 3, ...
+    int sum = 0;
+    int weight = 3;
+    for (int i = static_cast<int>(digits.size()) - 2; i >= 0; --i) {
+        sum += (digits[i] - '0') * weight;
+        weight = 4 - weight;
+    }
+    return (10 - sum % 10) % 10 == digits.back() - '0';
+}
+
+struct RowSymbol {
+    const char* type = nullptr;
+    std::string digits;
+    int first = 0;   // индекс первой полосы стартового ограничителя
+    int runs = 0;
+};
+
+// Поиск EAN-13 / EAN-8 в последовательности полос; полосы с нечётным индексом — штрихи.
+// Первая и последняя полосы обрезаны краем строки, поэтому тихая зона у них не проверяется
+std::optional<RowSymbol> decodeRuns(const std::vector<float>& widths) {
+    const int count = static_cast<int>(widths.size());
+
+    auto hasQuietZone = [&](int index, float module) {
+        return index == 0 || index == count - 1 || widths[index] >= module * kQuietZoneModules;
+    };
+
+    for (int start = 1; start < count; start += 2) {
+        const float* run = widths.data() + start;
+
+        if (start + kEan13Runs < count) {
+            const float module = std::accumulate(run, run + kEan13Runs, 0.0f) / kEan13Modules;
+            if (isGuard(run, 3, module) && isGuard(run + 27, 5, module) && isGuard(run + 56, 3, module)
+                && hasQuietZone(start - 1, module) && hasQuietZone(start + kEan13Runs, module)) {
+                std::string digits(13, '0');
+                int parity = 0;
+                bool valid = true;
+                for (int i = 0; i < 6 && valid; ++i) {
+                    float errorL = 0.0f;
+                    float errorG = 0.0f;
+                    const int digitL = matchDigit(run + 3 + i * 4, kLPatterns, errorL);
+                    const int digitG = matchDigit(run + 3 + i * 4, kGPatterns, errorG);
+                    const bool useG = digitG >= 0 && (digitL < 0 || errorG < errorL);
+                    const int digit = useG ? digitG : digitL;
+                    valid = digit >= 0;
+                    digits[1 + i] = static_cast<char>('0' + std::max(digit, 0));
+                    parity = (parity << 1) | (useG ? 1 : 0);
+                }
+                for (int i = 0; i < 6 && valid; ++i) {
+                    float error = 0.0f;
+                    const int digit = matchDigit(run + 32 + i * 4, kRPatterns, error);
+                    valid = digit >= 0;
+                    digits[7 + i] = static_cast<char>('0' + std::max(digit, 0));
+                }
+                const int firstDigit = valid ? kFirstDigitByParity[parity] : -1;
+                if (firstDigit >= 0) {
+                    digits[0] = static_cast<char>('0' + firstDigit);
+                    if (isCheckDigitValid(digits)) return RowSymbol{ "EAN-13", std::move(digits), start, kEan13Runs };
+                }
+            }
+        }
+
+        if (start + kEan8Runs < count) {
+            const float module = std::accumulate(run, run + kEan8Runs, 0.0f) / kEan8Modules;
+            if (isGuard(run, 3, module) && isGuard(run + 19, 5, module) && isGuard(run + 40, 3, module)
+                && hasQuietZone(start - 1, module) && hasQuietZone(start + kEan8Runs, module)) {
+                std::string digits(8, '0');
+                bool valid = true;
+                for (int i = 0; i < 8 && valid; ++i) {
+                    float error = 0.0f;
+                    const int offset = i < 4 ? 3 + i * 4 : 24 + (i - 4) * 4;
+                    const int digit = matchDigit(run + offset, i < 4 ? kLPatterns : kRPatterns, error);
+                    valid = digit >= 0;
+                    digits[i] = static_cast<char>('0' + std::max(digit, 0));
+                }
+                if (valid && isCheckDigitValid(digits)) return RowSymbol{ "EAN-8", std::move(digits), start, kEan8Runs };
+            }
+        }
+    }
+    return std::nullopt;
+}
+
+} // namespace
+
+std::optional<BarcodeResult> EanScanlineDecoder::decodeRow(const unsigned char* row, int width) const {
+    if (width < kEan8Modules) return std::nullopt;
+
+    const auto [darkest, lightest] = std::minmax_element(row, row + width);
+    if (*lightest - *darkest < kMinContrast) return std::nullopt;
+    const auto threshold = static_cast<std::uint8_t>((*darkest + *lightest + 1) / 2);
+
+    thread_local std::vector<int> edges;
+    thread_local std::vector<float> positions;
+    thread_local std::vector<float> widths;
+    findEdges(row, width, threshold, edges);
+    if (static_cast<int>(edges.size()) < kEan8Runs + 1) return std::nullopt;
+    refineEdges(row, width, threshold, edges, positions);
+
+    // Полосы между границами; нулевая и последняя — светлый фон до и после
+    widths.resize(positions.size() + 1);
+    widths.front() = positions.front();
+    for (std::size_t i = 1; i < positions.size(); ++i) widths[i] = positions[i] - positions[i - 1];
+    widths.back() = width - positions.back();
+
+    auto symbolEdges = [&](const RowSymbol& symbol) {
+        return std::make_pair(edges[symbol.first - 1], edges[symbol.first + symbol.runs - 1]);
+    };
+
+    std::optional<RowSymbol> symbol = decodeRuns(widths);
+    std::pair<int, int> span;
+    if (symbol) {
+        span = symbolEdges(*symbol);
+    } else {
+        // Код перевёрнут: читаем полосы справа налево
+        std::reverse(widths.begin(), widths.end());
+        symbol = decodeRuns(widths);
+        if (!symbol) return std::nullopt;
+        const int count = static_cast<int>(widths.size());
+        span = symbolEdges(RowSymbol{ nullptr, {}, count - symbol->first - symbol->runs, symbol->runs });
+    }
+
+    BarcodeResult result;
+    result.type = symbol->type;
+    result.digits = std::move(symbol->digits);
+    result.fullResult = result.type + ": " + result.digits;
+    result.location = { cv::Point(span.first, 0), cv::Point(span.second, 0) };
+    return result;
+}
+
+std::optional<BarcodeResult> EanScanlineDecoder::decode(const cv::Mat& image) const {
+    if (image.empty() || image.depth() != CV_8U) return std::nullopt;
+
+    cv::Mat gray = image;
+    if (image.channels() == 3) {
+        cv::cvtColor(image, gray, cv::COLOR_BGR2GRAY);
+    }
+    if (gray.channels() != 1 || gray.cols < kEan8Modules) return std::nullopt;
+
+    // Код принимается, когда он одинаково прочитан на двух строках (на очень низком регионе — на одной)
+    const int lines = std::min(kScanlines, gray.rows);
+    const int required = lines >= 3 ? 2 : 1;
+
+    struct Candidate {
+        BarcodeResult result;
+        int votes = 0;
+    };
+    std::vector<Candidate> candidates;
+
+    for (int line = 0; line < lines; ++line) {
+        const int y = gray.rows * (line + 1) / (lines + 1);
+        std::optional<BarcodeResult> found = decodeRow(gray.ptr<unsigned char>(y), gray.cols);
+        if (!found) continue;
+
+        auto candidate = std::find_if(candidates.begin(), candidates.end(), [&](const Candidate& known) {
+            return known.result.type == found->type && known.result.digits == found->digits;
+        });
+        if (candidate == candidates.end()) {
+            candidates.push_back({ *found, 0 });
+            candidate = std::prev(candidates.end());
+            candidate->result.location.clear();
+        }
+        for (const auto& point : found->location) candidate->result.location.emplace_back(point.x, y);
+
+        if (++candidate->votes >= required) {
+            std::cout << "EAN scanline decoded: " << candidate->result.fullResult << std::endl;
+            return std::move(candidate->result);
+        }
+    }
+    return std::nullopt;
+}
@@ -0,0 +1,84 @@
+#include "EnrichmentCache.h"
+#include <algorithm>
+
+EnrichmentCache& EnrichmentCache::instance()
+{
+    static EnrichmentCache cache;
+    return cache;
+}
+
+EnrichmentCache::EnrichmentCache(std::size_t capacity)
+    : capacity(std::max<std::size_t>(capacity, 1))
+{
+    byKey.reserve(this->capacity);
+}
+
+std::string EnrichmentCache::makeKey(const BarcodeResult& result)
+{
+    // Разделитель не встречается ни в названиях символик, ни в цифрах
+    std::string key;
+    key.reserve(result.type.size() + 1 + result.digits.size());
+    key.append(result.type).push_back('\x1f');
+    key.append(result.digits);
+    return key;
+}
+
+std::optional<BarcodeResult> EnrichmentCache::find(const BarcodeResult& basicResult)
+{
+    const std::string key = makeKey(basicResult);
+    {
+        std::lock_guard lock(mutex);
+        auto it = byKey.find(key);
+        if (it != byKey.end()) {
+            entries.splice(entries.begin(), entries, it->second);
+
+            BarcodeResult detailedResult = basicResult;
+            detailedResult.country = it->second->country;
+            detailedResult.manufacturerCode = it->second->manufacturerCode;
+            detailedResult.productCode = it->second->productCode;
+            hitCount.fetch_add(1, std::memory_order_relaxed);
+            return detailedResult;
+        }
+    }
+    missCount.fetch_add(1, std::memory_order_relaxed);
+    return std::nullopt;
+}
+
+void EnrichmentCache::insert(const BarcodeResult& detailedResult, std::uint64_t generation)
+{
+    std::string key = makeKey(detailedResult);
+
+    std::lock_guard lock(mutex);
+    // Справочники перезагрузились, пока шло обогащение — результат уже устарел
+    if (generation != currentGeneration.load(std::memory_order_relaxed)) return;
+
+    if (auto it = byKey.find(key); it != byKey.end()) {
+        it->second->country = detailedResult.country;
+        it->second->manufacturerCode = detailedResult.manufacturerCode;
+        it->second->productCode = detailedResult.productCode;
+        entries.splice(entries.begin(), entries, it->second);
+        return;
+    }
+
+    if (entries.size() >= capacity) {
+        byKey.erase(entries.back().key);
+        entries.pop_back();
+    }
+    entries.push_front({ key, detailedResult.country, detailedResult.manufacturerCode, detailedResult.productCode });
+    byKey.emplace(std::move(key), entries.begin());
+}
+
+void EnrichmentCache::invalidate()
+{
+    std::lock_guard lock(mutex);
+    currentGeneration.fetch_add(1, std::memory_order_release);
+    entries.clear();
+    byKey.clear();
+}
+
+EnrichmentCache::Stats EnrichmentCache::stats() const
+{
+    std::lock_guard lock(mutex);
+    return { hitCount.load(std::memory_order_relaxed), missCount.load(std::memory_order_relaxed),
+             entries.size(), capacity };
+}
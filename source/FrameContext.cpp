@@ -0,0 +1,42 @@
+#include "FrameContext.h"
+
+FrameContext::FrameContext(const cv::Mat& image) {
+    if (image.channels() == 3) {
+        cv::cvtColor(image, grayFrame, cv::COLOR_BGR2GRAY);
+    } else if (image.channels() == 4) {
+        cv::cvtColor(image, grayFrame, cv::COLOR_BGRA2GRAY);
+    } else {
+        // Уже серый: копия нужна, чтобы стадии не зависели от буфера вызывающего
+        grayFrame = image.clone();
+    }
+    pyramid.push_back(grayFrame);
+}
+
+cv::Mat FrameContext::grayRoi(const cv::Rect& rect) const {
+    const cv::Rect clipped = rect & cv::Rect(0, 0, grayFrame.cols, grayFrame.rows);
+    return clipped.empty() ? cv::Mat() : grayFrame(clipped);
+}
+
+const cv::Mat& FrameContext::pyramidLevel(int level) const {
+    std::lock_guard lock(mutex);
+    while (static_cast<int>(pyramid.size()) <= level) {
+        const cv::Mat& previous = pyramid.back();
+        if (previous.cols < 2 || previous.rows < 2) break;
+        cv::Mat next;
+        cv::pyrDown(previous, next);
+        pyramid.push_back(next);
+    }
+    return pyramid[std::min<std::size_t>(std::max(level, 0), pyramid.size() - 1)];
+}
+
+const FrameContext::Gradients& FrameContext::levelGradients(int level) const {
+    const cv::Mat& source = pyramidLevel(level);
+
+    std::lock_guard lock(mutex);
+    auto [it, inserted] = levelGradientCache.try_emplace(level);
+    if (inserted) {
+        cv::Sobel(source, it->second.dx, CV_16S, 1, 0, 3);
+        cv::Sobel(source, it->second.dy, CV_16S, 0, 1, 3);
+    }
+    return it->second;
+}
@@ -0,0 +1,60 @@
+#include "FrameRing.h"
+#include <algorithm>
+
+// Закрепление и выбор слота для записи упорядочены seq_cst: читатель увеличивает pins и затем
+// перечитывает latestIndex, писатель публикует latestIndex и затем проверяет pins. Поэтому
+// либо писатель видит закрепление и обходит слот, либо читатель видит, что слот уже не последний
+
+FrameRing::FrameRing(std::size_t slotCount)
+    : slotCount(std::max<std::size_t>(slotCount, 2)),
+    ring(std::make_unique<Slot[]>(this->slotCount)) {
+}
+
+cv::Mat* FrameRing::beginWrite() {
+    const int latest = latestIndex.load(std::memory_order_seq_cst);
+    for (std::size_t step = 1; step <= slotCount; ++step) {
+        const int index = static_cast<int>((writeIndex + step + slotCount) % slotCount);
+        if (index == latest) continue;
+        if (ring[index].pins.load(std::memory_order_seq_cst) != 0) continue;
+
+        writeIndex = index;
+        return &ring[index].image;
+    }
+    writeIndex = -1;
+    return nullptr;
+}
+
+void FrameRing::publish(Clock::time_point capturedAt) {
+    if (writeIndex < 0) return;
+
+    Slot& slot = ring[writeIndex];
+    slot.capturedAt = capturedAt;
+    slot.sequence = ++nextSequence;
+    slot.consumed.store(false, std::memory_order_relaxed);
+
+    const int previous = latestIndex.exchange(writeIndex, std::memory_order_seq_cst);
+    if (previous >= 0 && !ring[previous].consumed.load(std::memory_order_relaxed)) {
+        droppedCount.fetch_add(1, std::memory_order_relaxed);
+    }
+    publishedCount.fetch_add(1, std::memory_order_relaxed);
+}
+
+void FrameRing::reset() {
+    latestIndex.store(-1, std::memory_order_seq_cst);
+}
+
+FrameRing::FrameRef FrameRing::latest() const {
+    for (;;) {
+        const int index = latestIndex.load(std::memory_order_seq_cst);
+        if (index < 0) return FrameRef();
+
+        Slot& slot = ring[index];
+        slot.pins.fetch_add(1, std::memory_order_seq_cst);
+        // Слот мог смениться между чтением индекса и закреплением — тогда повторяем
+        if (latestIndex.load(std::memory_order_seq_cst) == index) {
+            slot.consumed.store(true, std::memory_order_relaxed);
+            return FrameRef(&slot);
+        }
+        slot.pins.fetch_sub(1, std::memory_order_release);
+    }
+}
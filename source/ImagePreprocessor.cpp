@@ -18,6 +18,15 @@ cv::Mat ImagePreprocessor::enhanceContrast(const cv::Mat& input) const {
     return result;
 }
 
+cv::Mat ImagePreprocessor::enhanceContrastGray(const cv::Mat& gray) const {
+    // Объект CLAHE переиспользуется в пределах потока
+    thread_local cv::Ptr<cv::CLAHE> clahe = cv::createCLAHE(2.0, cv::Size(8, 8));
+
+    cv::Mat result;
+    clahe->apply(gray, result);
+    return result;
+}
+
 
 
 cv::Mat ImagePreprocessor::enhanceSharpness(const cv::Mat& input, double strength) const{
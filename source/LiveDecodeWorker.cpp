@@ -0,0 +1,146 @@
+#include "LiveDecodeWorker.h"
+#include <QMetaType>
+#include <exception>
+#include <iostream>
+#include "CameraManager.h"
+#include "DecodeException.h"
+
+namespace {
+
+// Тот же код с соседних кадров отправляется повторно не чаще, чем раз в kRepeatHold
+constexpr auto kRepeatHold = std::chrono::seconds(2);
+constexpr auto kStatsWindow = std::chrono::seconds(1);
+
+double millisecondsSince(LiveDecodeWorker::Clock::time_point from) {
+    return std::chrono::duration<double, std::milli>(LiveDecodeWorker::Clock::now() - from).count();
+}
+
+} // namespace
+
+LiveDecodeWorker::LiveDecodeWorker(CameraManager* camera, QObject* parent)
+    : QObject(parent),
+    camera(camera)
+{
+    qRegisterMetaType<BarcodeResult>("BarcodeResult");
+}
+
+LiveDecodeWorker::~LiveDecodeWorker()
+{
+    stop();
+}
+
+void LiveDecodeWorker::start()
+{
+    if (running.exchange(true)) return;
+    {
+        std::lock_guard lock(mutex);
+        frameSignalled = true;   // кадр мог прийти до запуска
+    }
+    worker = std::thread(&LiveDecodeWorker::decodeLoop, this);
+}
+
+void LiveDecodeWorker::stop()
+{
+    {
+        std::lock_guard lock(mutex);
+        running = false;
+    }
+    wake.notify_one();
+    if (worker.joinable()) {
+        worker.join();
+    }
+}
+
+void LiveDecodeWorker::frameAvailable()
+{
+    {
+        std::lock_guard lock(mutex);
+        frameSignalled = true;
+    }
+    wake.notify_one();
+}
+
+bool LiveDecodeWorker::decodeFrame(const cv::Mat& image, BarcodeResult& result, QString& decoderName)
+{
+    const ScanReport report = reader1D.decode(image, ScanOptions::withBudget(kFrameBudget));
+    if (report.status == ScanStatus::Decoded) {
+        result = report.result;
+        decoderName = QString::fromStdString(reader1D.getDecoderName());
+        return true;
+    }
+
+    try {
+        result = reader2D.decode(image);
+        decoderName = QString::fromStdString(reader2D.getDecoderName());
+        return true;
+    }
+    catch (const DecodeException&) {
+        return false;
+    }
+}
+
+void LiveDecodeWorker::decodeLoop()
+{
+    std::uint64_t lastSequence = 0;
+    std::string lastDigits;
+    Clock::time_point lastEmittedAt;
+
+    Clock::time_point windowStart = Clock::now();
+    std::uint64_t windowFrames = 0;
+    std::uint64_t windowStale = 0;
+    double windowLatencyMs = 0.0;
+
+    for (;;) {
+        {
+            std::unique_lock lock(mutex);
+            wake.wait(lock, [this] { return frameSignalled || !running; });
+            if (!running) break;
+            frameSignalled = false;
+        }
+
+        // Кадр закреплён в кольце на время распознавания; новые кадры пишутся в другие слоты.
+        // peekFrame не трогает сигнал frameReady, который ждёт окно
+        const FrameRing::FrameRef frame = camera->peekFrame();
+        if (!frame || frame.sequence() == lastSequence) continue;
+        if (lastSequence != 0 && frame.sequence() > lastSequence + 1) {
+            windowStale += frame.sequence() - lastSequence - 1;
+        }
+        lastSequence = frame.sequence();
+
+        BarcodeResult result;
+        QString decoderName;
+        bool decoded = false;
+        try {
+            decoded = decodeFrame(frame.image(), result, decoderName);
+        }
+        catch (const BarcodeException& e) {
+            std::cerr << "Ошибка распознавания кадра камеры: " << e.what() << std::endl;
+        }
+        catch (const std::exception& e) {
+            // cv::Exception, bad_alloc: исключение не должно покинуть поток (std::terminate) — кадр пропускается
+            std::cerr << "Ошибка распознавания кадра камеры: " << e.what() << std::endl;
+        }
+        const double latencyMs = millisecondsSince(frame.capturedAt());
+
+        ++windowFrames;
+        windowLatencyMs += latencyMs;
+
+        if (decoded && !result.digits.empty()) {
+            const auto now = Clock::now();
+            if (result.digits != lastDigits || now - lastEmittedAt >= kRepeatHold) {
+                lastDigits = result.digits;
+                lastEmittedAt = now;
+                emit barcodeDecoded(result, decoderName, latencyMs);
+            }
+        }
+
+        if (Clock::now() - windowStart >= kStatsWindow) {
+            const double seconds = millisecondsSince(windowStart) / 1000.0;
+            emit statsUpdated(windowFrames / seconds, windowLatencyMs / windowFrames, windowStale);
+            windowStart = Clock::now();
+            windowFrames = 0;
+            windowStale = 0;
+            windowLatencyMs = 0.0;
+        }
+    }
+}
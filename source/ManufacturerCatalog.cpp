@@ -0,0 +1,182 @@
+#include "ManufacturerCatalog.h"
+#include <QFile>
+#include <QByteArray>
+#include <algorithm>
+#include <bit>
+#include <iostream>
+#include "CatalogText.h"
+#include "CompiledCatalog.h"
+#include "FileException.h"
+#include "ProductCatalog.h"
+
+namespace {
+
+constexpr std::size_t kMaxPrefixLength = 14;   // длиннее GTIN-14 префикс быть не может
+
+bool isPrefixCode(std::string_view code)
+{
+    return !code.empty() && code.size() <= kMaxPrefixLength
+           && code.find_first_not_of("0123456789") == std::string_view::npos;
+}
+
+} // namespace
+
+ManufacturerCatalog& ManufacturerCatalog::instance()
+{
+    static ManufacturerCatalog catalog;
+    return catalog;
+}
+
+template <typename Text>
+ManufacturerCatalog::Match ManufacturerCatalog::lookup(const Index& index, const Text& barcode)
+{
+    std::uint32_t bestEntry = 0;
+    int bestLength = 0;
+
+    // Спуск по дереву: одна цифра — один узел, запоминаем последний узел, где кончается префикс
+    std::uint32_t node = 0;
+    int depth = 0;
+    for (auto ch : barcode) {
+        const char16_t code = catalogCharCode(ch);
+        if (!isAsciiDigit(code)) break;
+
+        const Node& current = index.nodes[node];
+        const std::uint16_t bit = static_cast<std::uint16_t>(1u << (code - u'0'));
+        if (!(current.childMask & bit)) break;
+
+        node = current.firstChild + static_cast<std::uint32_t>(std::popcount<std::uint16_t>(current.childMask & (bit - 1)));
+        ++depth;
+        if (index.nodes[node].entry != 0) {
+            bestEntry = index.nodes[node].entry;
+            bestLength = depth;
+        }
+    }
+
+    if (bestEntry == 0) return {};
+    const QString description = index.compiled ? index.compiled->manufacturerAt(bestEntry - 1)
+                                               : index.descriptions[bestEntry - 1];
+    return { description, bestLength };
+}
+
+ManufacturerCatalog::Match ManufacturerCatalog::find(std::string_view barcode)
+{
+    return lookup(*snapshot.readOrCreate(&ManufacturerCatalog::buildIndex), barcode);
+}
+
+ManufacturerCatalog::Match ManufacturerCatalog::find(QStringView barcode)
+{
+    return lookup(*snapshot.readOrCreate(&ManufacturerCatalog::buildIndex), barcode);
+}
+
+void ManufacturerCatalog::find(std::span<const std::string_view> barcodes, std::span<Match> matches)
+{
+    auto index = snapshot.readOrCreate(&ManufacturerCatalog::buildIndex);
+    for (std::size_t i = 0; i < barcodes.size() && i < matches.size(); ++i) {
+        matches[i] = lookup(*index, barcodes[i]);
+    }
+}
+
+std::size_t ManufacturerCatalog::size()
+{
+    return snapshot.readOrCreate(&ManufacturerCatalog::buildIndex)->prefixCount;
+}
+
+void ManufacturerCatalog::reload()
+{
+    snapshot.publish(buildIndex());
+}
+
+std::unique_ptr<const ManufacturerCatalog::Index> ManufacturerCatalog::buildIndex()
+{
+    auto index = std::make_unique<Index>();
+    std::vector<Prefix> prefixes;
+
+    index->compiled = CompiledCatalog::defaultCatalog();
+    if (index->compiled) {
+        // Описания остаются в отображённом файле, в дереве — только номера записей
+        const std::size_t count = index->compiled->manufacturerCount();
+        prefixes.reserve(count);
+        for (std::size_t position = 0; position < count; ++position) {
+            std::string digits = ProductCatalog::unpackGtin(index->compiled->manufacturerKey(position));
+            if (isPrefixCode(digits)) {
+                prefixes.push_back({ std::move(digits), static_cast<std::uint32_t>(position + 1) });
+            }
+        }
+    } else {
+        loadFromFile("C:/Users/rauko/Desktop/BarcodeScanner/data/Barcode_Manufacturers.txt", *index, prefixes);
+    }
+
+    buildTrie(prefixes, index->nodes);
+    index->prefixCount = prefixes.size();
+    std::cout << "Дерево префиксов производителей построено: " << prefixes.size() << " префиксов, "
+              << index->nodes.size() << " узлов" << std::endl;
+    return index;
+}
+
+// 📂 Разбор файла производителей: "код:название:код страны"
+void ManufacturerCatalog::loadFromFile(const QString& filePath, Index& index, std::vector<Prefix>& prefixes)
+{
+    QFile file(filePath);
+    if (!file.open(QIODevice::ReadOnly)) {
+        throw FileException("Не удалось открыть файл производителей: " + filePath.toStdString());
+    }
+
+    const QByteArray content = file.readAll();
+    forEachManufacturerRecord(std::string_view(content.constData(), static_cast<std::size_t>(content.size())),
+                              [&](std::string_view code, std::string_view name, std::string_view country) {
+        if (!isPrefixCode(code)) return;
+
+        index.descriptions.push_back(QString::fromStdString(manufacturerDescription(code, name, country)));
+        prefixes.push_back({ std::string(code), static_cast<std::uint32_t>(index.descriptions.size()) });
+    });
+}
+
+void ManufacturerCatalog::buildTrie(std::vector<Prefix>& prefixes, std::vector<Node>& nodes)
+{
+    // Повторный код пропускаем: как и при линейном поиске, побеждает первая строка
+    std::stable_sort(prefixes.begin(), prefixes.end(),
+                     [](const Prefix& a, const Prefix& b) { return a.digits < b.digits; });
+    prefixes.erase(std::unique(prefixes.begin(), prefixes.end(),
+                               [](const Prefix& a, const Prefix& b) { return a.digits == b.digits; }),
+                   prefixes.end());
+
+    nodes.assign(1, Node{});
+    buildNode(prefixes, 0, prefixes.size(), 0, 0, nodes);
+    nodes.shrink_to_fit();
+}
+
+// Узел для отсортированного диапазона префиксов с общими первыми depth цифрами:
+// сначала резервируется блок под всех детей, затем каждый ребёнок строится рекурсивно
+void ManufacturerCatalog::buildNode(const std::vector<Prefix>& prefixes, std::size_t begin, std::size_t end,
+                                    std::size_t depth, std::uint32_t nodeIndex, std::vector<Node>& nodes)
+{
+    if (begin < end && prefixes[begin].digits.size() == depth) {
+        nodes[nodeIndex].entry = prefixes[begin].entry;
+        ++begin;
+    }
+
+    auto groupEnd = [&](std::size_t from) {
+        const char digit = prefixes[from].digits[depth];
+        std::size_t to = from + 1;
+        while (to < end && prefixes[to].digits[depth] == digit) ++to;
+        return to;
+    };
+
+    std::uint16_t childMask = 0;
+    for (std::size_t group = begin; group < end; group = groupEnd(group)) {
+        childMask |= static_cast<std::uint16_t>(1u << (prefixes[group].digits[depth] - '0'));
+    }
+    if (childMask == 0) return;
+
+    const auto firstChild = static_cast<std::uint32_t>(nodes.size());
+    nodes[nodeIndex].childMask = childMask;
+    nodes[nodeIndex].firstChild = firstChild;
+    nodes.resize(nodes.size() + std::popcount(childMask));
+
+    std::uint32_t child = firstChild;
+    for (std::size_t group = begin; group < end; ++child) {
+        const std::size_t next = groupEnd(group);
+        buildNode(prefixes, group, next, depth + 1, child, nodes);
+        group = next;
+    }
+}
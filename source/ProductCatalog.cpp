@@ -0,0 +1,166 @@
+#include "ProductCatalog.h"
+#include <QFile>
+#include <QByteArray>
+#include <algorithm>
+#include <iostream>
+#include "CatalogText.h"
+#include "CompiledCatalog.h"
+#include "FileException.h"
+
+namespace {
+
+constexpr std::size_t kMaxGtinLength = 14;   // GTIN-14 — самый длинный формат
+constexpr int kLengthShift = 56;             // 10^14 < 2^47, старшие биты свободны под длину
+constexpr std::uint64_t kUpcaLength = 12;
+constexpr std::uint64_t kEan13Length = 13;
+
+template <typename Digits>
+std::optional<std::uint64_t> packDigits(const Digits& digits)
+{
+    std::uint64_t value = 0;
+    std::size_t length = 0;
+    for (auto ch : digits) {
+        const char16_t code = catalogCharCode(ch);
+        if (!isAsciiDigit(code) || ++length > kMaxGtinLength) {
+            return std::nullopt;
+        }
+        value = value * 10 + (code - u'0');
+    }
+    if (length == 0) return std::nullopt;
+    return (static_cast<std::uint64_t>(length) << kLengthShift) | value;
+}
+
+// Ведущий ноль не меняет число, поэтому достаточно заменить длину 12 на 13
+std::optional<std::uint64_t> widenUpca(std::optional<std::uint64_t> key)
+{
+    if (key && (*key >> kLengthShift) == kUpcaLength) {
+        const std::uint64_t value = *key & ((std::uint64_t(1) << kLengthShift) - 1);
+        return (kEan13Length << kLengthShift) | value;
+    }
+    return key;
+}
+
+} // namespace
+
+ProductCatalog& ProductCatalog::instance()
+{
+    static ProductCatalog catalog;
+    return catalog;
+}
+
+std::optional<std::uint64_t> ProductCatalog::packGtin(std::string_view barcode)
+{
+    return packDigits(barcode);
+}
+
+std::optional<std::uint64_t> ProductCatalog::packGtin(QStringView barcode)
+{
+    return packDigits(barcode);
+}
+
+std::optional<std::uint64_t> ProductCatalog::productKey(std::string_view barcode)
+{
+    return widenUpca(packDigits(barcode));
+}
+
+std::optional<std::uint64_t> ProductCatalog::productKey(QStringView barcode)
+{
+    return widenUpca(packDigits(barcode));
+}
+
+std::string ProductCatalog::unpackGtin(std::uint64_t key)
+{
+    const auto length = std::min<std::size_t>(key >> kLengthShift, kMaxGtinLength);
+    std::uint64_t value = key & ((std::uint64_t(1) << kLengthShift) - 1);
+
+    std::string digits(length, '0');
+    for (std::size_t i = length; i > 0 && value != 0; --i, value /= 10) {
+        digits[i - 1] = static_cast<char>('0' + value % 10);
+    }
+    return digits;
+}
+
+QString ProductCatalog::find(std::uint64_t key)
+{
+    auto index = snapshot.readOrCreate(&ProductCatalog::buildIndex);
+    if (index->compiled) return index->compiled->findProduct(key);
+
+    auto it = index->entries.find(key);
+    return it != index->entries.end() ? it->second : QString();
+}
+
+QString ProductCatalog::find(std::string_view barcode)
+{
+    auto key = productKey(barcode);
+    return key ? find(*key) : QString();
+}
+
+QString ProductCatalog::find(QStringView barcode)
+{
+    auto key = productKey(barcode);
+    return key ? find(*key) : QString();
+}
+
+void ProductCatalog::find(std::span<const std::uint64_t> sortedKeys, std::span<QString> descriptions)
+{
+    auto index = snapshot.readOrCreate(&ProductCatalog::buildIndex);
+    if (index->compiled) {
+        index->compiled->findProducts(sortedKeys, descriptions);
+        return;
+    }
+
+    for (std::size_t i = 0; i < sortedKeys.size() && i < descriptions.size(); ++i) {
+        auto it = index->entries.find(sortedKeys[i]);
+        if (it != index->entries.end()) descriptions[i] = it->second;
+    }
+}
+
+std::size_t ProductCatalog::size()
+{
+    auto index = snapshot.readOrCreate(&ProductCatalog::buildIndex);
+    return index->compiled ? index->compiled->productCount() : index->entries.size();
+}
+
+void ProductCatalog::reload()
+{
+    snapshot.publish(buildIndex());
+}
+
+std::unique_ptr<const ProductCatalog::Index> ProductCatalog::buildIndex()
+{
+    auto index = std::make_unique<Index>();
+    index->compiled = CompiledCatalog::defaultCatalog();
+    if (!index->compiled) {
+        // Если файл не открылся — исключение; при первом обращении следующий вызов попробует снова
+        loadFromFile("C:/Users/rauko/Desktop/BarcodeScanner/data/Barcode_Products.txt", *index);
+    }
+    return index;
+}
+
+// 📂 Разбор файла товаров: "штрих-код | производитель | название"
+void ProductCatalog::loadFromFile(const QString& filePath, Index& index)
+{
+    QFile file(filePath);
+    if (!file.open(QIODevice::ReadOnly)) {
+        throw FileException("Не удалось открыть файл товаров: " + filePath.toStdString());
+    }
+
+    const QByteArray content = file.readAll();
+    const std::string_view text(content.constData(), static_cast<std::size_t>(content.size()));
+
+    auto& entries = index.entries;
+    entries.reserve(static_cast<std::size_t>(std::count(text.begin(), text.end(), '\n')) + 1);
+
+    forEachProductRecord(text, [&entries](std::string_view fileBarcode, std::string_view manufacturer,
+                                          std::string_view productName) {
+        auto key = productKey(fileBarcode);
+        if (!key) return;
+
+        // Повторный штрих-код пропускаем: как и при линейном поиске, побеждает первая строка
+        if (!entries.contains(*key)) {
+            entries.emplace(*key, QString::fromStdString(productDescription(fileBarcode, manufacturer, productName)));
+        }
+    });
+
+    std::cout << "Каталог товаров загружен: " << entries.size() << " позиций" << std::endl;
+}
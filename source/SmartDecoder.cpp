@@ -1,43 +1,220 @@
 #include "SmartDecoder.h"
+#include "CylinderUnwarp.h"
 #include "ZBarDecoder.h"
+#include <cmath>
+#include <cstdlib>
 #include <iostream>
+#include <optional>
 
-SmartDecoder::SmartDecoder(ImagePreprocessor& p, ZBarDecoder& d)
-    : preprocessor(p), decoder(d) {
-    // Дополнительная инициализация, если нужна
-    std::cout << "SmartDecoder initialized" << std::endl;
+namespace {
+
+const char* variantName(PreprocessVariant variant) {
+    switch (variant) {
+    case PreprocessVariant::Raw: return "raw";
+    case PreprocessVariant::Unwarped: return "unwarped";
+    case PreprocessVariant::Upscaled: return "upscaled";
+    case PreprocessVariant::Contrast: return "contrast";
+    case PreprocessVariant::Sharpened: return "sharpened";
+    }
+    return "?";
 }
 
-std::string SmartDecoder::smartDecodeWithUnwarp(const cv::Mat& frame, const cv::Rect& rect) {
-    if (rect.empty()) return "";
+// Ленивый генератор вариантов: перевод в серый делается один раз и общий для всех вариантов,
+// каждый следующий вариант строится только когда до него дошла очередь
+class VariantGenerator {
+public:
+    VariantGenerator(const ImagePreprocessor& preprocessor, const cv::Mat& roi)
+        : preprocessor(preprocessor), roi(roi) {}
+
+    struct Variant {
+        cv::Mat image;        // пустой — вариант к региону неприменим
+        double scale = 1.0;   // во сколько раз вариант больше региона
+        cv::Point offset{};   // начало варианта в регионе
+        std::optional<UnwarpParams> unwarp{};
+
+        // Точка варианта -> точка региона
+        cv::Point toRoi(const cv::Point& point) const {
+            cv::Point2f mapped(static_cast<float>(point.x / scale), static_cast<float>(point.y / scale));
+            if (unwarp) mapped = unwarp->sourcePoint(mapped);
+            return cv::Point(cvRound(mapped.x) + offset.x, cvRound(mapped.y) + offset.y);
+        }
+    };
+
+    Variant build(PreprocessVariant variant) {
+        switch (variant) {
+        case PreprocessVariant::Raw:
+            return { gray() };
+        case PreprocessVariant::Unwarped: {
+            // Размер округляется вниз до кратного 8 (обрезка по краям — до 3 пикселей),
+            // чтобы похожие регионы попадали в одни и те же таблицы remap
+            const cv::Size size(roi.cols & ~7, roi.rows & ~7);
+            if (size.width < 32 || size.height < 16) return {};
+            const cv::Point offset((roi.cols - size.width) / 2, (roi.rows - size.height) / 2);
+            const cv::Mat region = gray()(cv::Rect(offset, size));
+
+            UnwarpParams params = estimateUnwarp(region);
+            if (params.isIdentity()) return {};
+            return { unwarpRegion(region, params), 1.0, offset, params };
+        }
+        case PreprocessVariant::Upscaled: {
+            if (roi.cols >= 150) return {};
+            cv::Mat scaled;
+            double scale = std::min(3.0, 200.0 / roi.cols);
+            cv::resize(gray(), scaled, cv::Size(), scale, scale, cv::INTER_CUBIC);
+            return { scaled, scale };
+        }
+        case PreprocessVariant::Contrast:
+            return { preprocessor.enhanceContrastGray(gray()) };
+        case PreprocessVariant::Sharpened:
+            return { preprocessor.enhanceSharpness(gray(), 2.0) };
+        }
+        return {};
+    }
+
+private:
+    const cv::Mat& gray() {
+        if (!grayRoi) {
+            grayRoi.emplace();
+            if (roi.channels() == 3) {
+                cv::cvtColor(roi, *grayRoi, cv::COLOR_BGR2GRAY);
+            } else {
+                *grayRoi = roi;
+            }
+        }
+        return *grayRoi;
+    }
+
+    const ImagePreprocessor& preprocessor;
+    const cv::Mat& roi;
+    std::optional<cv::Mat> grayRoi;
+};
 
-    cv::Mat roi = frame(rect).clone();
-    std::vector<cv::Mat> processing_options;
+// Регион, повёрнутый так, чтобы штрихи стали вертикальными. Холст — описанный прямоугольник,
+// углы кода не обрезаются; toRegion переводит точки обратно в регион
+class OrientedRoi {
+public:
+    OrientedRoi(const cv::Mat& roi, double angle) : roi(roi) {
+        if (angle == 0.0) return;
 
-    processing_options.push_back(roi);
+        const cv::Point2f center((roi.cols - 1) * 0.5f, (roi.rows - 1) * 0.5f);
+        cv::Mat rotation = cv::getRotationMatrix2D(center, angle, 1.0);
+        const double cos_angle = std::abs(rotation.at<double>(0, 0));
+        const double sin_angle = std::abs(rotation.at<double>(0, 1));
+        const cv::Size canvas(cvRound(roi.cols * cos_angle + roi.rows * sin_angle),
+                              cvRound(roi.cols * sin_angle + roi.rows * cos_angle));
+        rotation.at<double>(0, 2) += (canvas.width - 1) * 0.5 - center.x;
+        rotation.at<double>(1, 2) += (canvas.height - 1) * 0.5 - center.y;
 
-    if (rect.width < 150) {
-        cv::Mat scaled;
-        double scale = std::min(3.0, 200.0 / rect.width);
-        cv::resize(roi, scaled, cv::Size(), scale, scale, cv::INTER_CUBIC);
-        processing_options.push_back(scaled);
+        cv::warpAffine(roi, rotated, rotation, canvas, cv::INTER_LINEAR, cv::BORDER_REPLICATE);
+        cv::invertAffineTransform(rotation, toRegion);
     }
 
-    processing_options.push_back(preprocessor.enhanceContrast(roi));
-    processing_options.push_back(preprocessor.enhanceSharpness(roi, 2.0));
+    const cv::Mat& image() const { return rotated.empty() ? roi : rotated; }
 
-    // УДАЛИТЕ эту строку - она лишняя и содержит ошибку:
-    // std::string result = decoder.decodeWithZBar(processing_options[i]);
+    cv::Point toRoi(const cv::Point& point) const {
+        if (toRegion.empty()) return point;
+        const double* row0 = toRegion.ptr<double>(0);
+        const double* row1 = toRegion.ptr<double>(1);
+        return cv::Point(cvRound(row0[0] * point.x + row0[1] * point.y + row0[2]),
+                         cvRound(row1[0] * point.x + row1[1] * point.y + row1[2]));
+    }
+
+private:
+    const cv::Mat& roi;
+    cv::Mat rotated;
+    cv::Mat toRegion;
+};
+
+} // namespace
+
+SmartDecoder::SmartDecoder(ImagePreprocessor& p, ZBarDecoder& d)
+    : preprocessor(p), decoder(d), variantOrder(defaultVariantOrder()) {
+}
 
-    for (int i = 0; i < processing_options.size(); i++) {
-        std::string result = decoder.decodeWithZBar(processing_options[i]); // Используйте decoder.
+std::vector<PreprocessVariant> SmartDecoder::parseVariantOrder(std::string_view text) {
+    std::vector<PreprocessVariant> order;
+    while (!text.empty()) {
+        const auto comma = text.find(',');
+        std::string_view name = text.substr(0, comma);
+        text = comma == std::string_view::npos ? std::string_view() : text.substr(comma + 1);
 
-        if (!result.empty()) {
-            std::cout << "Curved barcode decoded with option " << i << ": " << result << std::endl;
+        while (!name.empty() && name.front() == ' ') name.remove_prefix(1);
+        while (!name.empty() && name.back() == ' ') name.remove_suffix(1);
+
+        for (auto variant : { PreprocessVariant::Raw, PreprocessVariant::Unwarped, PreprocessVariant::Upscaled,
+                              PreprocessVariant::Contrast, PreprocessVariant::Sharpened }) {
+            if (name == variantName(variant)) order.push_back(variant);
+        }
+    }
+    return order;
+}
+
+const std::vector<PreprocessVariant>& SmartDecoder::defaultVariantOrder() {
+    static const std::vector<PreprocessVariant> order = [] {
+        if (const char* configured = std::getenv("BARCODE_VARIANT_ORDER")) {
+            auto parsed = parseVariantOrder(configured);
+            if (!parsed.empty()) return parsed;
+            std::cerr << "BARCODE_VARIANT_ORDER не распознан, используется порядок по умолчанию" << std::endl;
+        }
+        return std::vector<PreprocessVariant>{ PreprocessVariant::Raw, PreprocessVariant::Unwarped,
+                                               PreprocessVariant::Upscaled, PreprocessVariant::Contrast,
+                                               PreprocessVariant::Sharpened };
+    }();
+    return order;
+}
+
+std::optional<BarcodeResult> SmartDecoder::smartDecodeWithUnwarp(const cv::Mat& frame, const cv::Rect& rect, double angle,
+                                                               const CancellationToken* cancel) {
+    const cv::Rect clipped = rect & cv::Rect(0, 0, frame.cols, frame.rows);
+    if (clipped.empty()) return std::nullopt;
+
+    // Регион — представление кадра без копии (повёрнутый — единственная копия); варианты строятся по очереди
+    const cv::Mat roi = frame(clipped);
+    const OrientedRoi oriented(roi, angle);
+    VariantGenerator variants(preprocessor, oriented.image());
+
+    for (auto variant : variantOrder) {
+        if (cancel && cancel->isCancelled()) return std::nullopt;
+
+        auto option = variants.build(variant);
+        if (option.image.empty()) continue;
+
+        if (auto result = decoder.decodeBestWithZBar(option.image)) {
+            for (auto& point : result->location) {
+                point = oriented.toRoi(option.toRoi(point)) + clipped.tl();
+            }
+            std::cout << "Curved barcode decoded with option " << variantName(variant) << ": " << result->fullResult << std::endl;
             return result;
         }
     }
 
-    return "";
+    return std::nullopt;
+}
+
+std::vector<ZBarSymbol> SmartDecoder::decodeAllWithUnwarp(const cv::Mat& frame, const cv::Rect& rect, double angle,
+                                                          const CancellationToken* cancel) {
+    const cv::Rect clipped = rect & cv::Rect(0, 0, frame.cols, frame.rows);
+    if (clipped.empty()) return {};
+
+    const cv::Mat roi = frame(clipped);
+    const OrientedRoi oriented(roi, angle);
+    VariantGenerator variants(preprocessor, oriented.image());
+
+    for (auto variant : variantOrder) {
+        if (cancel && cancel->isCancelled()) return {};
+
+        auto option = variants.build(variant);
+        if (option.image.empty()) continue;
+
+        std::vector<ZBarSymbol> symbols = decoder.decodeAllWithZBar(option.image);
+        if (symbols.empty()) continue;
+
+        for (auto& symbol : symbols) {
+            for (auto& point : symbol.location) {
+                point = oriented.toRoi(option.toRoi(point)) + clipped.tl();
+            }
+        }
+        return symbols;
+    }
+    return {};
 }
-// УДАЛИТЕ лишнюю закрывающую скобку в конце файла
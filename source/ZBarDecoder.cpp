@@ -2,61 +2,89 @@
 #include "BarcodeResult.h"
 #include <iostream>
 
-
-
-ZBarDecoder::ZBarDecoder() {
-    zbar_scanner.set_config(zbar::ZBAR_NONE, zbar::ZBAR_CFG_ENABLE, 1);
+namespace {
+
+// Заголовок Mat поверх буфера потока: буфер растёт до наибольшего запрошенного размера
+// и не освобождается, поэтому повторные вызовы память не выделяют
+cv::Mat scratchMat(std::vector<uchar>& storage, int rows, int cols) {
+    const std::size_t bytes = static_cast<std::size_t>(rows) * cols;
+    if (storage.size() < bytes) storage.resize(bytes);
+    return cv::Mat(rows, cols, CV_8UC1, storage.data());
 }
 
-std::string ZBarDecoder::decodeWithZBar(const cv::Mat& roi) {
+// Изображение Y800 для ZBar. Непрерывный серый регион передаётся как есть; цветной,
+// несмежный (ROI с шагом строки больше ширины) или слишком маленький пишется в буферы потока
+cv::Mat prepareY800(const cv::Mat& roi, double& scale) {
+    thread_local std::vector<uchar> grayStorage;
+    thread_local std::vector<uchar> scaledStorage;
+
     cv::Mat gray;
     if (roi.channels() == 3) {
+        gray = scratchMat(grayStorage, roi.rows, roi.cols);
         cv::cvtColor(roi, gray, cv::COLOR_BGR2GRAY);
     }
+    else if (roi.isContinuous()) {
+        gray = roi;
+    }
     else {
-        gray = roi.clone();
+        // ZBar не знает о шаге строки — несмежный регион приходится уплотнить
+        gray = scratchMat(grayStorage, roi.rows, roi.cols);
+        roi.copyTo(gray);
     }
 
+    scale = 1.0;
     if (gray.cols < 100 || gray.rows < 40) {
-        double scale = std::max(150.0 / gray.cols, 60.0 / gray.rows);
-        cv::resize(gray, gray, cv::Size(), scale, scale, cv::INTER_CUBIC);
+        scale = std::max(150.0 / gray.cols, 60.0 / gray.rows);
+        cv::Mat scaled = scratchMat(scaledStorage, cvRound(gray.rows * scale), cvRound(gray.cols * scale));
+        cv::resize(gray, scaled, scaled.size(), 0, 0, cv::INTER_CUBIC);
+        return scaled;
     }
+    return gray;
+}
 
-    try {
-        zbar::Image zbar_image(gray.cols, gray.rows, "Y800", gray.data, gray.cols * gray.rows);
-        int scan_result = zbar_scanner.scan(zbar_image);
+bool isEanSymbol(const zbar::Symbol& symbol) {
+    const auto type = symbol.get_type();
+    return type == zbar::ZBAR_EAN13 || type == zbar::ZBAR_EAN8;
+}
 
-        std::string bestResult; // ????? ??????? ????? "???????" ?????????
-        std::string defaultResult; // ?????? ????????? ?????????
+// Контур — обратно в координаты исходного изображения (до увеличения)
+void readLocation(const zbar::Symbol& symbol, double scale, std::vector<cv::Point>& location) {
+    location.clear();
+    const int points = symbol.get_location_size();
+    for (int i = 0; i < points; ++i) {
+        location.emplace_back(cvRound(symbol.get_location_x(i) / scale), cvRound(symbol.get_location_y(i) / scale));
+    }
+}
 
-        if (scan_result > 0) {
-            for (zbar::Image::SymbolIterator symbol = zbar_image.symbol_begin();
-                 symbol != zbar_image.symbol_end(); ++symbol) {
+} // namespace
+
+ZBarDecoder::ZBarDecoder() {
+    zbar_scanner.set_config(zbar::ZBAR_NONE, zbar::ZBAR_CFG_ENABLE, 1);
 
-                std::string type_name = symbol->get_type_name();
-                std::string data = symbol->get_data();
+    strip_scanner.set_config(zbar::ZBAR_NONE, zbar::ZBAR_CFG_ENABLE, 1);
+    strip_scanner.set_config(zbar::ZBAR_NONE, zbar::ZBAR_CFG_X_DENSITY, 0);
+    strip_scanner.set_config(zbar::ZBAR_NONE, zbar::ZBAR_CFG_Y_DENSITY, 4);
+}
 
-                std::cout << "ZBar detected: " << type_name << " - " << data << std::endl;
+template<typename Visit>
+void ZBarDecoder::scanSymbols(zbar::ImageScanner& scanner, const cv::Mat& roi, Visit&& visit) {
+    if (roi.empty()) return;
 
-                std::string currentResult = type_name + ": " + data;
+    // Один zbar::Image на поток: меняются только размер и указатель на данные
+    thread_local zbar::Image zbar_image;
 
-                // ????????? ?????? ?????????
-                if (defaultResult.empty()) {
-                    defaultResult = currentResult;
-                }
+    double scale = 1.0;
+    const cv::Mat gray = prepareY800(roi, scale);
 
-                // ???????????? ???????????? ????? ?????-?????
-                // (????????, EAN-13/8 ????? ??????? ??? QR-CODE ??? ???????)
-                if (type_name.find("EAN") != std::string::npos)      {
-                    bestResult = currentResult;
-                }
-            }
+    try {
+        zbar_image.set_format("Y800");
+        zbar_image.set_size(gray.cols, gray.rows);
+        zbar_image.set_data(gray.data, static_cast<unsigned long>(gray.cols) * gray.rows);
 
-            // ?????????? ?????? ????????? ??? ?????? ?????????
-            if (!bestResult.empty()) {
-                return bestResult;
-            } else if (!defaultResult.empty()) {
-                return defaultResult;
+        if (scanner.scan(zbar_image) > 0) {
+            for (zbar::Image::SymbolIterator symbol = zbar_image.symbol_begin();
+                 symbol != zbar_image.symbol_end(); ++symbol) {
+                visit(*symbol, scale);
             }
         }
     }
@@ -65,7 +93,57 @@ std::string ZBarDecoder::decodeWithZBar(const cv::Mat& roi) {
     } catch (const BarcodeException& e) {
         std::cerr << "Barcode error: " << e.what() << std::endl;
     }
-    return "";
+
+    // Символы возвращаются сканеру, изображение не держит ни их, ни буфер кадра
+    scanner.recycle_image(zbar_image);
+    zbar_image.set_data(nullptr, 0);
+}
+
+std::optional<BarcodeResult> ZBarDecoder::decodeBestWithZBar(const cv::Mat& roi) {
+    return decodeBest(zbar_scanner, roi);
+}
+
+std::optional<BarcodeResult> ZBarDecoder::decodeStrip(const cv::Mat& strip) {
+    return decodeBest(strip_scanner, strip);
+}
+
+std::optional<BarcodeResult> ZBarDecoder::decodeBest(zbar::ImageScanner& scanner, const cv::Mat& roi) {
+    if (auto native = eanDecoder.decode(roi)) {
+        return native;
+    }
+
+    // Предпочитаем EAN (последний из найденных), иначе — первый символ
+    std::optional<BarcodeResult> best;
+    scanSymbols(scanner, roi, [&best](const zbar::Symbol& symbol, double scale) {
+        if (best && !isEanSymbol(symbol)) return;
+        if (!best) best.emplace();
+        best->type = symbol.get_type_name();
+        best->digits = symbol.get_data();
+        readLocation(symbol, scale, best->location);
+    });
+
+    if (best) {
+        best->fullResult = best->type + ": " + best->digits;
+        std::cout << "ZBar detected: " << best->type << " - " << best->digits << std::endl;
+    }
+    return best;
+}
+
+std::string ZBarDecoder::decodeWithZBar(const cv::Mat& roi) {
+    std::optional<BarcodeResult> result = decodeBestWithZBar(roi);
+    return result ? result->fullResult : "";
+}
+
+std::vector<ZBarSymbol> ZBarDecoder::decodeAllWithZBar(const cv::Mat& roi) {
+    std::vector<ZBarSymbol> symbols;
+    scanSymbols(zbar_scanner, roi, [&symbols](const zbar::Symbol& symbol, double scale) {
+        ZBarSymbol& found = symbols.emplace_back();
+        found.type = symbol.get_type_name();
+        found.data = symbol.get_data();
+        readLocation(symbol, scale, found.location);
+        std::cout << "ZBar detected: " << found.type << " - " << found.data << std::endl;
+    });
+    return symbols;
 }
 
 std::string ZBarDecoder::filterBarcodeResult(const std::string& result) {
@@ -102,3 +180,12 @@ BarcodeResult ZBarDecoder::parseZBarResult(std::string_view zbarResult){
 
     return result;
 }
+
+BarcodeResult ZBarDecoder::toBarcodeResult(const ZBarSymbol& symbol) {
+    BarcodeResult result;
+    result.type = symbol.type;
+    result.digits = symbol.data;
+    result.fullResult = symbol.type + ": " + symbol.data;
+    result.location = symbol.location;
+    return result;
+}
@@ -1,15 +1,17 @@
 #include "mainwindow.h"
 #include <QApplication>
 #include <QClipboard>
+#include <QStatusBar>
 
 #include "ImageLoadException.h"
 #include "DecodeException.h"
 #include "FileException.h"
 #include "CameraException.h"
-#include "ImageBuffer.h"
 
 MainWindow::~MainWindow()
 {
+    // Воркер держит кадры кольца камеры — останавливается до неё
+    liveDecoder->stop();
     delete cameraManager;
     delete imageManager;
 }
@@ -17,7 +19,9 @@ MainWindow::~MainWindow()
 MainWindow::MainWindow(QWidget* parent)
     : QMainWindow(parent),
     cameraManager(new CameraManager(this)),
-    imageManager(new ImageManager(this))  // Инициализация в списке инициализации
+    imageManager(new ImageManager(this)),  // Инициализация в списке инициализации
+    catalogWatcher(new CatalogWatcher("C:/Users/rauko/Desktop/BarcodeScanner/data", this)),
+    liveDecoder(new LiveDecodeWorker(cameraManager, this))
 {
     // Добавляем все декодеры в список
     decoders.push_back(std::make_unique<BarcodeReader>());
@@ -38,11 +42,23 @@ void MainWindow::setupConnections()
     connect(cameraManager, &CameraManager::cameraStopped, this, &MainWindow::onCameraStopped);
     connect(cameraManager, &CameraManager::cameraError, this, &MainWindow::onCameraError);
 
+    // LiveDecodeWorker: о новом кадре узнаёт прямо в потоке захвата, результаты — очередью в поток окна
+    connect(cameraManager, &CameraManager::frameCaptured, liveDecoder, &LiveDecodeWorker::frameAvailable,
+            Qt::DirectConnection);
+    connect(liveDecoder, &LiveDecodeWorker::barcodeDecoded, this, &MainWindow::onLiveBarcodeDecoded,
+            Qt::QueuedConnection);
+    connect(liveDecoder, &LiveDecodeWorker::statsUpdated, this, &MainWindow::onLiveDecodeStats,
+            Qt::QueuedConnection);
+
     // ImageManager
     connect(imageManager, &ImageManager::imageLoaded, this, &MainWindow::onImageLoaded);
     connect(imageManager, &ImageManager::imageCleared, this, &MainWindow::onImageCleared);
     connect(imageManager, &ImageManager::imageError, this, &MainWindow::onImageError);
 
+    // CatalogWatcher (сигналы приходят из фонового потока — соединение будет очередным)
+    connect(catalogWatcher, &CatalogWatcher::catalogReloaded, this, &MainWindow::onCatalogReloaded);
+    connect(catalogWatcher, &CatalogWatcher::catalogReloadFailed, this, &MainWindow::onCatalogReloadFailed);
+
     // Buttons
     connect(loadButton, &QPushButton::clicked, this, &MainWindow::loadImage);
     connect(scanButton, &QPushButton::clicked, this, &MainWindow::scanBarcode);
@@ -136,9 +152,12 @@ void MainWindow::scanBarcode() {
             throw ImageLoadException("Нет изображения или камеры для сканирования");
         }
 
-        cv::Mat imageToScan = cameraManager->isCameraActive()
-                                  ? cameraManager->getCurrentFrame()
-                                  : imageManager->getCurrentImage();
+        // Кадр камеры закрепляется в кольце на время сканирования, без копии
+        FrameRing::FrameRef cameraFrame;
+        if (cameraManager->isCameraActive()) {
+            cameraFrame = cameraManager->latestFrame();
+        }
+        cv::Mat imageToScan = cameraFrame ? cameraFrame.image() : imageManager->getCurrentImage();
 
         resultText->append("🔍 Начинаю сканирование...");
 
@@ -213,33 +232,14 @@ void MainWindow::toggleCamera()
 
 
 
-void MainWindow::onCameraFrameReady(const cv::Mat& frame)
+void MainWindow::onCameraFrameReady()
 {
-    displayImage(frame);
-
-    static int frameCounter = 0;
-    frameCounter++;
-
-    if (frameCounter % 5 == 0 && !frame.empty()) {
-        try {
-            cameraBuffer << frame;
-        } catch (const BarcodeException& e) {
-            resultText->append(QString("⚠️ Ошибка буфера: ") + e.what());
-            return;
-        }
-    }
+    // Кадр закреплён в кольце камеры на время обработки — без копии
+    const FrameRing::FrameRef frameRef = cameraManager->latestFrame();
+    if (!frameRef) return;
 
-        for (const auto& img : cameraBuffer) {
-            for (const auto& decoder : decoders) {
-                BarcodeResult result = decoder->decode(img);
-                if (result.type != "Неизвестно" && !result.digits.empty()) {
-                    processBarcodeResult(result);
-                    cameraBuffer.clear();
-                    frameCounter = 0;
-                    return;
-                }
-            }
-        }
+    // Распознавание идёт в LiveDecodeWorker — здесь только показ
+    displayImage(frameRef.image());
 }
 
 void MainWindow::onCameraStarted()
@@ -247,11 +247,14 @@ void MainWindow::onCameraStarted()
     cameraButton->setText("📷 Выключить камеру");
     resultText->append("✅ Камера успешно подключена!");
     resultText->append("📷 Камера включена. Наведите на штрих-код...");
+    liveDecoder->start();
     updateScanButtonState();
 }
 
 void MainWindow::onCameraStopped()
 {
+    liveDecoder->stop();
+    statusBar()->clearMessage();
     cameraButton->setText("📷 Включить камеру");
     resultText->append("📷 Камера выключена");
     updateScanButtonState();
@@ -264,6 +267,26 @@ void MainWindow::onCameraError(const QString& error)
     updateScanButtonState();
 }
 
+// --- LiveDecodeWorker slots ---
+void MainWindow::onLiveBarcodeDecoded(const BarcodeResult& result, const QString& decoderName, double latencyMs)
+{
+    // Декодер окна с тем же именем — через него потом сохраняется результат
+    for (const auto& decoder : decoders) {
+        if (QString::fromStdString(decoder->getDecoderName()) == decoderName) {
+            lastDecoder = decoder.get();
+        }
+    }
+    processBarcodeResult(result);
+    resultText->append("⏱ От кадра до результата: " + QString::number(latencyMs, 'f', 0) + " мс");
+}
+
+void MainWindow::onLiveDecodeStats(double decodeFps, double latencyMs, quint64 staleFrames)
+{
+    statusBar()->showMessage("Распознавание: " + QString::number(decodeFps, 'f', 1) + " кадр/с, задержка "
+                             + QString::number(latencyMs, 'f', 0) + " мс, пропущено кадров: "
+                             + QString::number(staleFrames));
+}
+
 // --- ImageManager slots ---
 void MainWindow::onImageLoaded(const QString& filePath, const QSize& size)
 {
@@ -285,6 +308,19 @@ void MainWindow::onImageError(const QString& error)
     QMessageBox::warning(this, "Ошибка изображения", error);
 }
 
+// --- CatalogWatcher slots ---
+void MainWindow::onCatalogReloaded(const QString& fileName, qint64 buildMs, qint64 latencyMs)
+{
+    resultText->append("🔄 Справочник обновлён: " + fileName
+                       + " (построение " + QString::number(buildMs) + " мс, задержка "
+                       + QString::number(latencyMs) + " мс)");
+}
+
+void MainWindow::onCatalogReloadFailed(const QString& fileName, const QString& error)
+{
+    resultText->append("⚠️ Не удалось обновить справочник " + fileName + ": " + error);
+}
+
 // --- Общие методы ---
 void MainWindow::displayImage(const cv::Mat& image)
 {
@@ -0,0 +1,107 @@
+#include <QCoreApplication>
+#include <QDir>
+#include <QElapsedTimer>
+#include <iostream>
+#include "CompiledCatalog.h"
+#include "BarcodeException.h"
+#include "ProductCatalog.h"
+
+// catalog-compile — офлайн-сборка справочников data/*.txt в один бинарный Barcode_Catalog.bin
+//   catalog-compile <папка data> [выходной файл]
+//   catalog-compile --verify <файл каталога>
+
+namespace {
+
+void printUsage()
+{
+    std::cerr << "Использование:\n"
+              << "  catalog-compile <папка data> [выходной файл]\n"
+              << "  catalog-compile --verify <файл каталога>" << std::endl;
+}
+
+// UPC-A в каталоге — GTIN-13 с ведущим нулём; его же должен находить 12-значный код.
+// Возвращает число товаров, которые по 12 цифрам не находятся
+std::size_t checkUpcaLookups(const CompiledCatalog& catalog)
+{
+    std::size_t missing = 0;
+    for (std::size_t i = 0; i < catalog.productCount(); ++i) {
+        const std::uint64_t key = catalog.productKey(i);
+        const std::string digits = ProductCatalog::unpackGtin(key);
+        if (digits.size() == 12) {
+            ++missing;   // ключ старого вида: декодер пришлёт 13 цифр
+            continue;
+        }
+        if (digits.size() != 13 || digits.front() != '0') continue;
+
+        const auto upca = ProductCatalog::productKey(std::string_view(digits).substr(1));
+        if (!upca || catalog.findProduct(*upca) != catalog.findProduct(key)) ++missing;
+    }
+    return missing;
+}
+
+int verifyCatalog(const QString& catalogPath)
+{
+    QElapsedTimer timer;
+    timer.start();
+
+    CompiledCatalog catalog;
+    if (!catalog.open(catalogPath, true)) {
+        std::cerr << "❌ Каталог не прошёл проверку: " << catalogPath.toStdString() << std::endl;
+        return 1;
+    }
+    if (const std::size_t missing = checkUpcaLookups(catalog); missing != 0) {
+        std::cerr << "❌ Товары UPC-A не находятся по 12 цифрам: " << missing << std::endl;
+        return 1;
+    }
+
+    std::cout << "✅ Каталог корректен: " << catalog.productCount() << " товаров, "
+              << catalog.manufacturerCount() << " производителей (" << timer.elapsed() << " мс)" << std::endl;
+    return 0;
+}
+
+} // namespace
+
+int main(int argc, char* argv[])
+{
+    QCoreApplication app(argc, argv);
+    const QStringList args = QCoreApplication::arguments();
+
+    if (args.size() < 2 || args.size() > 3) {
+        printUsage();
+        return 2;
+    }
+
+    if (args.at(1) == "--verify") {
+        if (args.size() != 3) {
+            printUsage();
+            return 2;
+        }
+        return verifyCatalog(args.at(2));
+    }
+
+    const QDir dataDir(args.at(1));
+    const QString outputPath = args.size() == 3 ? args.at(2) : dataDir.filePath("Barcode_Catalog.bin");
+
+    try {
+        QElapsedTimer timer;
+        timer.start();
+
+        const CompiledCatalog::BuildStats stats = CompiledCatalog::compile(
+            dataDir.filePath("Barcode_Products.txt"),
+            dataDir.filePath("Barcode_Manufacturers.txt"),
+            dataDir.filePath("Barcode_Countries.txt"),
+            outputPath);
+
+        std::cout << "✅ Каталог собран: " << outputPath.toStdString() << "\n"
+                  << "   товаров: " << stats.products << "\n"
+                  << "   производителей: " << stats.manufacturers << "\n"
+                  << "   стран: " << stats.countries << "\n"
+                  << "   размер: " << stats.fileSize << " байт, время: " << timer.elapsed() << " мс" << std::endl;
+    }
+    catch (const BarcodeException& e) {
+        std::cerr << "❌ " << e.what() << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,148 @@
+#include <opencv2/opencv.hpp>
+#include <array>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+#include "CurvedBarcodeDetector.h"
+#include "FrameContext.h"
+
+// curved-masks-bench — замер масок поиска изогнутых регионов: прежняя цепочка OpenCV
+// (adaptiveThreshold x2, Otsu, Sobel + convertScaleAbs + addWeighted + threshold) против
+// CurvedBarcodeDetector::computeBinaryMasks, плюс параллельный проход по контурам на обоих наборах масок.
+//   curved-masks-bench [--iterations N] [изображение...]
+// Без изображений — синтетические кадры 640x480: шум, размытый шум и штрихи с шумом
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+using Masks = std::array<cv::Mat, 4>;
+
+const char* const kMaskNames[4] = { "адаптивный 21", "адаптивный 31", "Otsu", "градиент" };
+
+void printUsage()
+{
+    std::cerr << "Использование:\n"
+              << "  curved-masks-bench [--iterations N] [изображение...]" << std::endl;
+}
+
+// Цепочка до объединения масок в один проход. Градиенты уровня здесь считаются заново:
+// раньше их строил FrameContext только ради этой маски
+Masks opencvMasks(const cv::Mat& gray)
+{
+    Masks masks;
+    cv::adaptiveThreshold(gray, masks[0], 255, cv::ADAPTIVE_THRESH_GAUSSIAN_C, cv::THRESH_BINARY, 21, 5);
+    cv::adaptiveThreshold(gray, masks[1], 255, cv::ADAPTIVE_THRESH_GAUSSIAN_C, cv::THRESH_BINARY, 31, 10);
+    cv::threshold(gray, masks[2], 0, 255, cv::THRESH_BINARY | cv::THRESH_OTSU);
+
+    cv::Mat dx;
+    cv::Mat dy;
+    cv::Sobel(gray, dx, CV_16S, 1, 0, 3);
+    cv::Sobel(gray, dy, CV_16S, 0, 1, 3);
+    cv::Mat abs_x;
+    cv::Mat abs_y;
+    cv::convertScaleAbs(dx, abs_x);
+    cv::convertScaleAbs(dy, abs_y);
+    cv::addWeighted(abs_x, 0.5, abs_y, 0.5, 0, masks[3]);
+    cv::threshold(masks[3], masks[3], 50, 255, cv::THRESH_BINARY);
+    return masks;
+}
+
+// Среднее время вызова в миллисекундах; первый вызов — прогрев, не считается
+template <typename Function>
+double averageMs(int iterations, Function&& function)
+{
+    function();
+    const auto started = Clock::now();
+    for (int i = 0; i < iterations; ++i) function();
+    return std::chrono::duration<double, std::milli>(Clock::now() - started).count() / iterations;
+}
+
+std::vector<std::pair<std::string, cv::Mat>> syntheticFrames()
+{
+    cv::RNG rng(17);
+    cv::Mat noise(480, 640, CV_8UC1);
+    rng.fill(noise, cv::RNG::UNIFORM, 0, 256);
+
+    cv::Mat blurred;
+    cv::GaussianBlur(noise, blurred, cv::Size(0, 0), 3.0);
+
+    cv::Mat stripes(480, 640, CV_8UC1, cv::Scalar(200));
+    int x = 200;
+    while (x < 440) {
+        const int width = rng.uniform(2, 9);
+        cv::rectangle(stripes, cv::Rect(x, 170, width, 140), cv::Scalar(40), cv::FILLED);
+        x += width + rng.uniform(2, 9);
+    }
+    cv::Mat grain(480, 640, CV_8UC1);
+    rng.fill(grain, cv::RNG::NORMAL, 128, 12);
+    cv::addWeighted(stripes, 1.0, grain, 1.0, -128.0, stripes);
+
+    return { { "шум", noise }, { "размытый шум", blurred }, { "штрихи", stripes } };
+}
+
+} // namespace
+
+int main(int argc, char* argv[])
+{
+    int iterations = 50;
+    std::vector<std::pair<std::string, cv::Mat>> frames;
+
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+        if (arg == "--iterations") {
+            if (i + 1 >= argc || (iterations = std::atoi(argv[++i])) <= 0) {
+                printUsage();
+                return 2;
+            }
+            continue;
+        }
+        cv::Mat image = cv::imread(arg);
+        if (image.empty()) {
+            std::cerr << "❌ Не удалось загрузить изображение: " << arg << std::endl;
+            return 1;
+        }
+        frames.emplace_back(arg, image);
+    }
+    if (frames.empty()) frames = syntheticFrames();
+
+    const CurvedBarcodeDetector detector;
+    double total_opencv = 0.0;
+    double total_fused = 0.0;
+
+    for (const auto& [name, image] : frames) {
+        // Маски строятся на том же уровне пирамиды, что и в детекторе
+        const FrameContext frame(image);
+        const int level = detector.detectionLevel(frame.size());
+        const cv::Mat& gray = frame.pyramidLevel(level);
+        const FrameContext::Gradients& gradients = frame.levelGradients(level);
+
+        const Masks reference = opencvMasks(gray);
+        const Masks fused = detector.computeBinaryMasks(gray);
+
+        const double opencv_ms = averageMs(iterations, [&] { opencvMasks(gray); });
+        const double fused_ms = averageMs(iterations, [&] { detector.computeBinaryMasks(gray); });
+        const double opencv_contours_ms = averageMs(iterations, [&] { detector.contourCandidates(reference, gradients); });
+        const double fused_contours_ms = averageMs(iterations, [&] { detector.contourCandidates(fused, gradients); });
+        total_opencv += opencv_ms + opencv_contours_ms;
+        total_fused += fused_ms + fused_contours_ms;
+
+        std::cout << "📷 " << name << " (уровень " << level << ", " << gray.cols << "x" << gray.rows << ")\n"
+                  << "   маски: OpenCV " << opencv_ms << " мс, один проход " << fused_ms << " мс\n"
+                  << "   контуры: по маскам OpenCV " << opencv_contours_ms << " мс ("
+                  << detector.contourCandidates(reference, gradients).size() << " кандидатов), по маскам прохода "
+                  << fused_contours_ms << " мс (" << detector.contourCandidates(fused, gradients).size()
+                  << " кандидатов)\n";
+
+        const double pixels = static_cast<double>(gray.total());
+        for (std::size_t i = 0; i < fused.size(); ++i) {
+            const int differing = cv::countNonZero(reference[i] != fused[i]);
+            std::cout << "   расхождение маски \"" << kMaskNames[i] << "\": " << 100.0 * differing / pixels << "%\n";
+        }
+    }
+
+    std::cout << "✅ Итого (маски + контуры) на " << frames.size() << " кадрах: OpenCV " << total_opencv
+              << " мс, один проход " << total_fused << " мс" << std::endl;
+    return 0;
+}